@@ -0,0 +1,481 @@
+/*
+ * File: btree.c
+ *
+ * Description: Contains the unique and parity interfaces for an ordered set of strings kept in a B+tree. Every node is NODE_SIZE bytes, aligned to a cache line, so a search touches a few whole lines per level instead of one string per comparison as sorted.c does. Each key is kept with its first eight bytes packed into an integer, so most comparisons never load the string. The inner nodes hold the shortest prefixes that separate their children instead of whole words, and the leaves are linked in order, so the words can be listed in sorted order without searching. Appending in sorted order fills each node completely, which bulk loads the tree from sorted input. Removing an element never merges nodes, so the separators always stay valid.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <assert.h>
+#include "set.h"
+#include "arena.h"
+
+#define LINE_SIZE 64
+#define NODE_SIZE 256
+#define LEAF_KEYS ((NODE_SIZE - 16) / 16)
+#define INNER_KEYS ((NODE_SIZE - 16) / 24)
+
+typedef struct leaf{
+    int count;
+    struct leaf *next; //next leaf in sorted order
+    unsigned long long prefix[LEAF_KEYS];
+    char *keys[LEAF_KEYS];
+} LEAF;
+
+typedef struct inner{
+    int count;
+    unsigned long long prefix[INNER_KEYS];
+    char *keys[INNER_KEYS]; //separators, keys[i] <= every key under child[i+1]
+    void *child[INNER_KEYS + 1];
+} INNER;
+
+typedef struct set{
+    int count;
+    int height; //number of inner levels above the leaves
+    void *root;
+    LEAF *head; //first leaf
+    LEAF *tail; //last leaf
+    ARENA *arena; //holds the strings in the leaves
+} SET;
+
+/*
+ * Prefix Function (Private): Returns the first eight bytes of s packed into an integer, first byte highest, so that comparing two prefixes as integers orders them as strcmp would.
+ *
+ * Big O Complexity: O(1)
+ *
+ */
+static unsigned long long prefix(char *s)
+{
+    unsigned long long p = 0;
+    int i;
+    for(i = 0; i < 8 && s[i] != '\0'; i++)
+    {
+        p |= (unsigned long long) (unsigned char) s[i] << (56 - 8 * i);
+    }
+    return p;
+}
+
+/*
+ * Compare Function (Private): Compares string a with prefix pa to string b with prefix pb as strcmp would, only loading the strings when the prefixes are equal and both strings go on past them.
+ *
+ * Big O Complexity: O(1) average case
+ *
+ */
+static int compare(unsigned long long pa, char *a, unsigned long long pb, char *b)
+{
+    if(pa != pb)
+        return pa < pb ? -1 : 1;
+    if((pa & 0xff) == 0)
+        return 0;
+    return strcmp(a + 8, b + 8);
+}
+
+/*
+ * Locate Function (Private): Searches the n sorted keys of a node for elt with prefix p and returns the index of the first key that is not less than elt. found is set if that key equals elt.
+ *
+ * Big O Complexity: O(log n)
+ *
+ */
+static int locate(unsigned long long *prefixes, char **keys, int n, unsigned long long p, char *elt, bool *found)
+{
+    int lo = 0;
+    int hi = n;
+    int mi;
+    int x;
+    while(lo < hi)
+    {
+        mi = (lo + hi)/2;
+        x = compare(p, elt, prefixes[mi], keys[mi]);
+        if(x < 0)
+            hi = mi;
+        else if(x > 0)
+            lo = mi + 1;
+        else
+        {
+            *found = true;
+            return mi;
+        }
+    }
+    *found = false;
+    return lo;
+}
+
+/*
+ * Allocate Node Function (Private): Allocates an empty node aligned to a cache line.
+ *
+ * Big O Complexity: O(1)
+ *
+ */
+static void *allocNode(void)
+{
+    void *np = aligned_alloc(LINE_SIZE, NODE_SIZE);
+    assert(np != NULL);
+    memset(np, 0, NODE_SIZE);
+    return np;
+}
+
+/*
+ * Separator Function (Private): Returns an allocated copy of the shortest prefix of right that is greater than left, where left < right. Every key from right onwards is at least the separator.
+ *
+ * Big O Complexity: O(k)
+ *
+ */
+static char *separator(char *left, char *right)
+{
+    int d = 0;
+    while(left[d] == right[d])
+        d++;
+    char *sep = strndup(right, d + 1);
+    assert(sep != NULL);
+    return sep;
+}
+
+/*
+ * Descend Function (Private): Returns the leaf that would hold elt with prefix p.
+ *
+ * Big O Complexity: O(log n)
+ *
+ */
+static LEAF *descend(SET *sp, unsigned long long p, char *elt)
+{
+    void *np = sp->root;
+    bool found;
+    int i, idx;
+    for(i = 0; i < sp->height; i++)
+    {
+        INNER *ip = np;
+        idx = locate(ip->prefix, ip->keys, ip->count, p, elt, &found);
+        np = ip->child[found ? idx + 1 : idx];
+    }
+    return np;
+}
+
+/*
+ * Split Leaf Function (Private): Adds copy with prefix p at index idx of the full leaf lp by moving the upper keys to a new leaf, and returns the new leaf with its separator in sep. When copy goes past the end of the last leaf, lp is left full and the new leaf gets only copy, so that sorted input packs the leaves.
+ *
+ * Big O Complexity: O(1)
+ *
+ */
+static LEAF *splitLeaf(SET *sp, LEAF *lp, int idx, unsigned long long p, char *copy, char **sep)
+{
+    unsigned long long prefixes[LEAF_KEYS + 1];
+    char *keys[LEAF_KEYS + 1];
+    LEAF *rp = allocNode();
+    int i, half;
+
+    memcpy(prefixes, lp->prefix, sizeof(lp->prefix[0]) * idx);
+    memcpy(keys, lp->keys, sizeof(lp->keys[0]) * idx);
+    prefixes[idx] = p;
+    keys[idx] = copy;
+    memcpy(prefixes + idx + 1, lp->prefix + idx, sizeof(lp->prefix[0]) * (LEAF_KEYS - idx));
+    memcpy(keys + idx + 1, lp->keys + idx, sizeof(lp->keys[0]) * (LEAF_KEYS - idx));
+
+    half = (lp == sp->tail && idx == LEAF_KEYS) ? LEAF_KEYS : (LEAF_KEYS + 1)/2;
+    memcpy(lp->prefix, prefixes, sizeof(prefixes[0]) * half);
+    memcpy(lp->keys, keys, sizeof(keys[0]) * half);
+    lp->count = half;
+    for(i = half; i <= LEAF_KEYS; i++)
+    {
+        rp->prefix[i - half] = prefixes[i];
+        rp->keys[i - half] = keys[i];
+    }
+    rp->count = LEAF_KEYS + 1 - half;
+
+    rp->next = lp->next;
+    lp->next = rp;
+    if(sp->tail == lp)
+        sp->tail = rp;
+    *sep = separator(lp->keys[lp->count - 1], rp->keys[0]);
+    return rp;
+}
+
+/*
+ * Split Inner Function (Private): Adds separator sep with right child rp at index idx of the full inner node ip by moving the upper keys and children to a new node, and returns the new node with the separator to move up in sep. On the rightmost path, an addition at the end leaves ip full for the same reason as splitLeaf.
+ *
+ * Big O Complexity: O(1)
+ *
+ */
+static INNER *splitInner(INNER *ip, int idx, char **sep, void *rp, bool rightmost)
+{
+    char *keys[INNER_KEYS + 1];
+    void *child[INNER_KEYS + 2];
+    INNER *np = allocNode();
+    int i, half;
+
+    memcpy(keys, ip->keys, sizeof(ip->keys[0]) * idx);
+    keys[idx] = *sep;
+    memcpy(keys + idx + 1, ip->keys + idx, sizeof(ip->keys[0]) * (INNER_KEYS - idx));
+    memcpy(child, ip->child, sizeof(ip->child[0]) * (idx + 1));
+    child[idx + 1] = rp;
+    memcpy(child + idx + 2, ip->child + idx + 1, sizeof(ip->child[0]) * (INNER_KEYS - idx));
+
+    half = (rightmost && idx == INNER_KEYS) ? INNER_KEYS : (INNER_KEYS + 1)/2;
+    for(i = 0; i < half; i++)
+    {
+        ip->keys[i] = keys[i];
+        ip->prefix[i] = prefix(keys[i]);
+        ip->child[i] = child[i];
+    }
+    ip->child[half] = child[half];
+    ip->count = half;
+    for(i = half + 1; i <= INNER_KEYS; i++)
+    {
+        np->keys[i - half - 1] = keys[i];
+        np->prefix[i - half - 1] = prefix(keys[i]);
+        np->child[i - half - 1] = child[i];
+    }
+    np->child[INNER_KEYS - half] = child[INNER_KEYS + 1];
+    np->count = INNER_KEYS - half;
+    *sep = keys[half];
+    return np;
+}
+
+/*
+ * Insert Function (Private): Adds elt with prefix p below node np at the given height unless it is already there, setting added if it was. If np had to be split, returns the new right node with its separator in sep, otherwise returns NULL.
+ *
+ * Big O Complexity: O(log n)
+ *
+ */
+static void *insert(SET *sp, void *np, int height, bool rightmost, unsigned long long p, char *elt, bool *added, char **sep)
+{
+    bool found;
+    int i, idx;
+    if(height == 0)
+    {
+        LEAF *lp = np;
+        idx = locate(lp->prefix, lp->keys, lp->count, p, elt, &found);
+        if(found == true)
+            return NULL;
+        *added = true;
+        char *copy = arenaDup(sp->arena, elt);
+        if(lp->count == LEAF_KEYS)
+            return splitLeaf(sp, lp, idx, p, copy, sep);
+        for(i = lp->count; i > idx; i--)
+        {
+            lp->prefix[i] = lp->prefix[i-1];
+            lp->keys[i] = lp->keys[i-1];
+        }
+        lp->prefix[idx] = p;
+        lp->keys[idx] = copy;
+        lp->count += 1;
+        return NULL;
+    }
+
+    INNER *ip = np;
+    idx = locate(ip->prefix, ip->keys, ip->count, p, elt, &found);
+    if(found == true)
+        idx++;
+    void *rp = insert(sp, ip->child[idx], height - 1, rightmost && idx == ip->count, p, elt, added, sep);
+    if(rp == NULL)
+        return NULL;
+    if(ip->count == INNER_KEYS)
+        return splitInner(ip, idx, sep, rp, rightmost);
+    for(i = ip->count; i > idx; i--)
+    {
+        ip->prefix[i] = ip->prefix[i-1];
+        ip->keys[i] = ip->keys[i-1];
+        ip->child[i+1] = ip->child[i];
+    }
+    ip->prefix[idx] = prefix(*sep);
+    ip->keys[idx] = *sep;
+    ip->child[idx+1] = rp;
+    ip->count += 1;
+    return NULL;
+}
+
+/*
+ * Destroy Node Function (Private): Frees node np at the given height, everything below it, and the separators it holds.
+ *
+ * Big O Complexity: O(n)
+ *
+ */
+static void destroyNode(void *np, int height)
+{
+    int i;
+    if(height > 0)
+    {
+        INNER *ip = np;
+        for(i = 0; i <= ip->count; i++)
+        {
+            destroyNode(ip->child[i], height - 1);
+        }
+        for(i = 0; i < ip->count; i++)
+        {
+            free(ip->keys[i]);
+        }
+    }
+    free(np);
+}
+
+/*
+ * Create Set Function: Creates structure set sp holding a single empty leaf. The tree grows as needed, so maxElts is only checked.
+ *
+ * Big O Complexity: O(1)
+ *
+ */
+SET *createSet(int maxElts)
+{
+    assert(maxElts > 0);
+    assert(sizeof(LEAF) <= NODE_SIZE && sizeof(INNER) <= NODE_SIZE);
+    SET *sp = malloc(sizeof(SET));
+    assert(sp != NULL);
+    sp->count = 0;
+    sp->height = 0;
+    sp->root = sp->head = sp->tail = allocNode();
+    sp->arena = createArena();
+    return sp;
+}
+
+/*
+ * Destroy Set Function: Destroys set sp, freeing every node and separator and releasing the arena holding the strings.
+ *
+ * Big O Complexity: O(n)
+ *
+ */
+void destroySet(SET *sp)
+{
+    assert(sp != NULL);
+    destroyNode(sp->root, sp->height);
+    destroyArena(sp->arena);
+    free(sp);
+}
+
+/*
+ * Number of Elements Function: Returns sp->count.
+ *
+ * Big O Complexity: O(1)
+ *
+ */
+int numElements(SET *sp)
+{
+    assert(sp != NULL);
+    return sp->count;
+}
+
+/*
+ * Add Element Function: Checks if element is within sp, if not, function adds element. An element past the end of the last leaf is appended to it directly while it has room.
+ *
+ * Big O Complexity: O(log n)
+ *
+ */
+void addElement(SET *sp, char *elt)
+{
+    assert(sp != NULL && elt != NULL);
+    unsigned long long p = prefix(elt);
+    LEAF *lp = sp->tail;
+    bool added = false;
+    char *sep;
+
+    if(lp->count > 0 && lp->count < LEAF_KEYS && compare(p, elt, lp->prefix[lp->count - 1], lp->keys[lp->count - 1]) > 0)
+    {
+        lp->prefix[lp->count] = p;
+        lp->keys[lp->count] = arenaDup(sp->arena, elt);
+        lp->count += 1;
+        sp->count += 1;
+        return;
+    }
+
+    void *rp = insert(sp, sp->root, sp->height, true, p, elt, &added, &sep);
+    if(rp != NULL)
+    {
+        INNER *ip = allocNode();
+        ip->count = 1;
+        ip->prefix[0] = prefix(sep);
+        ip->keys[0] = sep;
+        ip->child[0] = sp->root;
+        ip->child[1] = rp;
+        sp->root = ip;
+        sp->height += 1;
+    }
+    if(added == true)
+        sp->count += 1;
+}
+
+/*
+ * Remove Element Function: Checks if element is within sp, if so, function removes element from its leaf. The leaf is left as it is even if it becomes empty.
+ *
+ * Big O Complexity: O(log n)
+ *
+ */
+void removeElement(SET *sp, char *elt)
+{
+    assert(sp != NULL && elt != NULL);
+    unsigned long long p = prefix(elt);
+    LEAF *lp = descend(sp, p, elt);
+    bool found;
+    int i;
+    int idx = locate(lp->prefix, lp->keys, lp->count, p, elt, &found);
+    if(found == true)
+    {
+        arenaFree(sp->arena, lp->keys[idx]);
+        for(i = idx + 1; i < lp->count; i++)
+        {
+            lp->prefix[i-1] = lp->prefix[i];
+            lp->keys[i-1] = lp->keys[i];
+        }
+        lp->count -= 1;
+        sp->count -= 1;
+    }
+}
+
+/*
+ * Find Element Function: Finds element within SET *sp, the element is returned if it is found & NULL if not found.
+ *
+ * Big O Complexity: O(log n)
+ *
+ */
+char *findElement(SET *sp, char *elt)
+{
+    assert(sp != NULL && elt != NULL);
+    unsigned long long p = prefix(elt);
+    LEAF *lp = descend(sp, p, elt);
+    bool found;
+    int idx = locate(lp->prefix, lp->keys, lp->count, p, elt, &found);
+    if(found == false)
+        return NULL;
+    return lp->keys[idx];
+}
+
+/*
+ * Get Elements Function: Copies the strings in sp in sorted order to **data (char) and returns **data (char).
+ *
+ * Big O Complexity: O(n)
+ *
+ */
+char **getElements(SET *sp)
+{
+    assert(sp != NULL);
+    char **data = malloc(sizeof(char *)*(sp->count > 0 ? sp->count : 1));
+    assert(data != NULL);
+    LEAF *lp;
+    int i, j = 0;
+    for(lp = sp->head; lp != NULL; lp = lp->next)
+    {
+        for(i = 0; i < lp->count; i++)
+        {
+            data[j++] = strdup(lp->keys[i]);
+        }
+    }
+    return data;
+}
+
+/*
+ * Visit Elements Function: Calls visit(elt, arg) on each element in sorted order, following the links between the leaves.
+ *
+ * Big O Complexity: O(n)
+ *
+ */
+void visitElements(SET *sp, void (*visit)(), void *arg)
+{
+    assert(sp != NULL && visit != NULL);
+    LEAF *lp;
+    int i;
+    for(lp = sp->head; lp != NULL; lp = lp->next)
+    {
+        for(i = 0; i < lp->count; i++)
+        {
+            (*visit)(lp->keys[i], arg);
+        }
+    }
+}
@@ -27,4 +27,6 @@ char *findElement(SET *sp, char *elt);
 
 char **getElements(SET *sp);
 
+void visitElements(SET *sp, void (*visit)(), void *arg);
+
 # endif /* SET_H */
@@ -4,45 +4,145 @@
 #include <stdbool.h>
 #include <assert.h>
 #include "set.h"
+#include "arena.h"
+
+#define TAIL_MIN 1024 //smallest tail that is sorted before merging
+#define SHORT_TAIL 8 //largest tail that is inserted one at a time
+#define REBUILD 16 //an index rebuild costs at most this many lookups each
+#define LINE_SIZE 64
 
 typedef struct set{
     int count;
     int length;
     char **data;
+    char **spare; //array the tail is merged into
+    unsigned long long *eyPrefixes; //prefixes in Eytzinger order, from 1
+    int *eyIndex; //index into data of each entry of eyPrefixes
+    bool stale; //data has changed since the index was built
+    int lookups; //lookups since data last changed
+    char **tail; //strings added since the last flush, unsorted
+    int tailCount;
+    int tailLength;
+    int tailIdx; //index in data of tail[0], which data cannot change before a flush
+    ARENA *arena; //holds the strings in data and tail
 
 } SET;
 
 /*
- * Search Function (Private): Searches for elements in a sequantial fashion within a SET *sp.
+ * Prefix Function (Private): Returns the first eight bytes of s packed into an integer, first byte highest, so that comparing two prefixes as integers orders them as strcmp would.
+ *
+ * Big O Complexity: O(1)
+ *
+ */
+static unsigned long long prefix(char *s)
+{
+    unsigned long long p = 0;
+    int i;
+    for(i = 0; i < 8 && s[i] != '\0'; i++)
+    {
+        p |= (unsigned long long) (unsigned char) s[i] << (56 - 8 * i);
+    }
+    return p;
+}
+
+/*
+ * Build Function (Private): Fills in the Eytzinger index from node k on by an in-order walk, starting at index i of sp->data, and returns the next index of sp->data. Node k has children 2k and 2k + 1, so the top levels of the tree share a few cache lines and the four grandchildren of a node are next to each other.
+ *
+ * Big O Complexity: O(n)
+ *
+ */
+static int build(SET *sp, int i, int k)
+{
+    if(k <= sp->count)
+    {
+        i = build(sp, i, 2 * k);
+        sp->eyPrefixes[k] = prefix(sp->data[i]);
+        sp->eyIndex[k] = i;
+        i = build(sp, i + 1, 2 * k + 1);
+    }
+    return i;
+}
+
+/*
+ * Ready Function (Private): Counts a lookup while the index is out of date and rebuilds it once there have been enough lookups since sp->data last changed to pay for it, that is, more than sp->count / REBUILD. Returns whether the index is up to date.
  *
- * Big O Complexity: O(log n)
+ * Big O Complexity: O(1) amortized
+ *
+ */
+static bool ready(SET *sp)
+{
+    if(++sp->lookups * REBUILD <= sp->count)
+        return false;
+    if(sp->eyPrefixes == NULL)
+    {
+        sp->eyPrefixes = aligned_alloc(LINE_SIZE, (sizeof(unsigned long long)*(sp->length + 1) + LINE_SIZE - 1) / LINE_SIZE * LINE_SIZE);
+        sp->eyIndex = malloc(sizeof(int)*(sp->length + 1));
+        assert(sp->eyPrefixes != NULL && sp->eyIndex != NULL);
+    }
+    build(sp, 0, 1);
+    sp->stale = false;
+    return true;
+}
+
+/*
+ * Search Function (Private): Returns the index of the first string in sp->data that is not less than elt, setting found if it equals elt. While the index is up to date, the search descends it without branching on the comparisons, prefetching the grandchildren of each node, and only loads a string on a tie between prefixes. Otherwise sp->data is searched directly, with branches, since a string comparison is slow enough that the processor does better to guess its result and load ahead. Keeping the index up to date on every change would double the cost of shifting sp->data, which is what parity spends its time on.
+ *
+ * Big O Complexity: O(log n) amortized
  *
  */
 static int search(SET *sp, char *elt, bool *found)
 {
     assert(sp != NULL);
-    int lo = 0;
-    int hi = sp->count -1;
-    int mi;
-    int x;
+    unsigned long long p;
+    int idx, k, lo, hi, mi, x;
+
+    if(sp->stale == false || ready(sp) == true)
+    {
+        p = prefix(elt);
+        for(k = 1; k <= sp->count; )
+        {
+            __builtin_prefetch(sp->eyPrefixes + 4 * k);
+            x = sp->eyPrefixes[k] == p && (p & 0xff) != 0 ? strcmp(sp->data[sp->eyIndex[k]] + 8, elt + 8) < 0 : sp->eyPrefixes[k] < p;
+            k = 2 * k + x;
+        }
+        k >>= __builtin_ffs(~k);
+        idx = k == 0 ? sp->count : sp->eyIndex[k];
+        *found = idx < sp->count && sp->eyPrefixes[k] == p && ((p & 0xff) == 0 || strcmp(sp->data[idx] + 8, elt + 8) == 0);
+        return idx;
+    }
+
+    lo = 0;
+    hi = sp->count - 1;
     while(lo <= hi)
     {
         mi = (lo + hi)/2;
         x = strcmp(elt, sp->data[mi]);
         if(x < 0)
-            hi = mi -1;
+            hi = mi - 1;
         else if(x > 0)
             lo = mi + 1;
         else
         {
             *found = true;
             return mi;
-        }    
+        }
     }
     *found = false;
     return lo;
 }
 
+/*
+ * Changed Function (Private): Marks the index as out of date after sp->data has changed.
+ *
+ * Big O Complexity: O(1)
+ *
+ */
+static void changed(SET *sp)
+{
+    sp->stale = true;
+    sp->lookups = 0;
+}
+
 /*
  * Create Set Function: Creates structure set sp with length (variable), count (variable) & data (array).
  *
@@ -56,60 +156,165 @@ SET *createSet(int maxElts)
     sp->length = maxElts;
     sp->count = 0;
     sp->data = malloc(sizeof(char *)*maxElts);
+    sp->spare = NULL;
+    sp->eyPrefixes = NULL;
+    sp->eyIndex = NULL;
+    sp->stale = true;
+    sp->lookups = 0;
+    sp->tailCount = 0;
+    sp->tailLength = TAIL_MIN;
+    sp->tail = malloc(sizeof(char *)*sp->tailLength);
+    assert(sp->data != NULL && sp->tail != NULL);
+    sp->arena = createArena();
     return sp;
 }
 
 /*
- * Destroy Set Function: Destroys a set beginning with strings, deleting so->data, freeing memory & ending with SET sp. 
+ * Destroy Set Function: Destroys a set beginning with strings, releasing the arena holding them one chunk at a time, deleting so->data, freeing memory & ending with SET sp. 
  *
- * Big O Complexity: O(n)
+ * Big O Complexity: O(c)
  *
  */
 void destroySet(SET *sp)
 {
     assert(sp != NULL);
-    int i;
-    for(i = 0; i < sp->count; i++)
-        free(sp->data[i]);
+    destroyArena(sp->arena);
+    free(sp->tail);
+    free(sp->eyIndex);
+    free(sp->eyPrefixes);
+    free(sp->spare);
     free(sp->data);
     free(sp);
 }
 
 /*
- * Number of Elements Function: Returns sp->count.
+ * Insert Function (Private): Inserts the string copy, already in the arena, at index idx of sp->data by shifting the strings after it.
+ *
+ * Big O Complexity: O(n)
+ *
+ */
+static void insert(SET *sp, char *copy, int idx)
+{
+    int i;
+    assert(sp->count < sp->length);
+    for(i = sp->count; i > idx; i--)
+    {
+        sp->data[i] = sp->data[i-1];
+    }
+    sp->data[idx] = copy;
+    sp->count += 1;
+    changed(sp);
+}
+
+/*
+ * Compare Strings Function (Private): Compares the strings pointed to by a and b for qsort.
  *
  * Big O Complexity: O(1)
  *
  */
+static int compareStrings(const void *a, const void *b)
+{
+    return strcmp(*(char **) a, *(char **) b);
+}
+
+/*
+ * Flush Function (Private): Moves the strings in sp->tail into sp->data so that it is sorted and complete again. A short tail is inserted one string at a time, and the first string of it needs no search, since addElement already found its index. A longer one is sorted, stripped of duplicates, and merged with sp->data into sp->spare, which then becomes sp->data. Duplicates are freed.
+ *
+ * Big O Complexity: O(n + t log t)
+ *
+ */
+static void flush(SET *sp)
+{
+    int i, j, k, n;
+    int x;
+    if(sp->tailCount <= SHORT_TAIL)
+    {
+        for(i = 0; i < sp->tailCount; i++)
+        {
+            bool found;
+            int idx = i == 0 ? sp->tailIdx : search(sp, sp->tail[i], &found);
+            if(i > 0 && found == true)
+                arenaFree(sp->arena, sp->tail[i]);
+            else
+                insert(sp, sp->tail[i], idx);
+        }
+        sp->tailCount = 0;
+        return;
+    }
+
+    qsort(sp->tail, sp->tailCount, sizeof(char *), compareStrings);
+    for(i = 0, k = 0; i < sp->tailCount; i++)
+    {
+        if(k > 0 && strcmp(sp->tail[i], sp->tail[k-1]) == 0)
+            arenaFree(sp->arena, sp->tail[i]);
+        else
+            sp->tail[k++] = sp->tail[i];
+    }
+
+    if(sp->spare == NULL)
+    {
+        sp->spare = malloc(sizeof(char *)*sp->length);
+        assert(sp->spare != NULL);
+    }
+    for(i = 0, j = 0, n = 0; i < sp->count || j < k; n++)
+    {
+        assert(n < sp->length);
+        if(i == sp->count)
+            x = 1;
+        else if(j == k)
+            x = -1;
+        else
+            x = strcmp(sp->data[i], sp->tail[j]);
+        if(x == 0)
+            arenaFree(sp->arena, sp->tail[j++]);
+        sp->spare[n] = x > 0 ? sp->tail[j++] : sp->data[i++];
+    }
+
+    char **data = sp->data;
+    sp->data = sp->spare;
+    sp->spare = data;
+    sp->count = n;
+    sp->tailCount = 0;
+    changed(sp);
+}
+
+/*
+ * Number of Elements Function: Flushes the tail and returns sp->count.
+ *
+ * Big O Complexity: O(1) amortized
+ *
+ */
 int numElements(SET *sp)
 {
     assert(sp != NULL);
+    flush(sp);
     return sp->count;
 }
 
 /*
- * Add Element Function: Checks if element is within sp->data, if not, function adds element.
+ * Add Element Function: Checks if element is within sp->data, if not, function copies element onto the end of sp->tail instead of shifting sp->data to make room for it. The tail may hold the element more than once. The tail is flushed once it is as long as sp->data, so each string takes part in O(log n) merges in all.
  *
- * Big O Complexity: O(n)
+ * Big O Complexity: O(log n) amortized
  *
  */
 void addElement(SET *sp, char *elt)
 {
     assert(sp != NULL);
     bool found;
-    int idx = 0;
-    
-    idx = search(sp, elt, &found);
-    if(found == false)
+    int idx = search(sp, elt, &found);
+    if(found == true)
+        return;
+    if(sp->tailCount == 0)
+        sp->tailIdx = idx;
+    if(sp->tailCount == sp->tailLength)
     {
-	int i;
-        for(i = sp->count; i > idx; i--)
-        {
-            sp->data[i] = sp->data[i-1];
-        }
-        sp->data[idx] = strdup(elt);
-        sp->count += 1;
+        sp->tailLength *= 2;
+        sp->tail = realloc(sp->tail, sizeof(char *)*sp->tailLength);
+        assert(sp->tail != NULL);
     }
+    sp->tail[sp->tailCount++] = arenaDup(sp->arena, elt);
+    if(sp->tailCount >= TAIL_MIN && sp->tailCount >= sp->count)
+        flush(sp);
 }
 
 /*
@@ -121,29 +326,32 @@ void addElement(SET *sp, char *elt)
 void removeElement(SET *sp, char *elt)
 {
     assert(sp != NULL);
+    flush(sp);
     bool found;
     int idx = search(sp, elt, &found);
     if(found == true)
     {
-        free(sp->data[idx]);
+        arenaFree(sp->arena, sp->data[idx]);
         int i;
         for(i = idx + 1; i < sp->count; i ++)
         {
             sp->data[i-1] = sp->data[i];
         }
         sp->count -= 1;
+        changed(sp);
     }
 }
 
 /*
  * Find Element Function: Finds element within SET *sp, the element is returned if it is found & throws false if not found.
  *
- * Big O Complexity: O(n)
+ * Big O Complexity: O(log n) amortized
  *
  */
 char *findElement(SET *sp, char *elt)
 {
     assert(sp != NULL);
+    flush(sp);
     bool found;
     int idx;
     idx = search(sp, elt, & found);
@@ -161,6 +369,7 @@ char *findElement(SET *sp, char *elt)
 char **getElements(SET *sp)
 {
     assert(sp != NULL);
+    flush(sp);
     int i;
     char **data = malloc(sizeof(char *)*(sp->count));
     for(i = 0; i < sp->count; i++)
@@ -169,3 +378,20 @@ char **getElements(SET *sp)
     }
     return data;
 }
+
+/*
+ * Visit Elements Function: Calls visit(elt, arg) on each element in SET *sp in place, without copying the array or the strings.
+ *
+ * Big O Complexity: O(n)
+ *
+ */
+void visitElements(SET *sp, void (*visit)(), void *arg)
+{
+    int i;
+    assert(sp != NULL && visit != NULL);
+    flush(sp);
+    for(i = 0; i < sp->count; i++)
+    {
+        (*visit)(sp->data[i], arg);
+    }
+}
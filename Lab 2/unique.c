@@ -26,6 +26,18 @@
 # define MAX_SIZE 18000
 
 
+/*
+ * Function:    printElement
+ *
+ * Description: Print the word ELT on a line of its own.
+ */
+
+static void printElement(char *elt, void *arg)
+{
+    printf("%s\n", elt);
+}
+
+
 /*
  * Function:    main
  *
@@ -35,7 +47,7 @@
 int main(int argc, char *argv[])
 {
     FILE *fp;
-    char buffer[BUFSIZ], **elts;
+    char buffer[BUFSIZ];
     SET *unique;
     int i, words;
     bool lflag = false;
@@ -104,12 +116,7 @@ int main(int argc, char *argv[])
     /* Print the list of words if desired. */
 
     if (lflag) {
-	elts = getElements(unique);
-
-	for (i = 0; i < numElements(unique); i ++)
-	    printf("%s\n", elts[i]);
-
-	free(elts);
+	visitElements(unique, printElement, NULL);
     }
 
     destroySet(unique);
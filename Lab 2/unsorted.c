@@ -4,27 +4,155 @@
 #include <stdbool.h>
 #include <assert.h>
 #include "set.h"
+#include "arena.h"
+#include "hash.h"
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define WIDTH 32 //fingerprints compared per instruction
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define WIDTH 16
+#else
+#define WIDTH 1
+#endif
+
+#define LINE_SIZE 64
+#define BITS_PER_ELT 16 //filter bits for each element the set can hold
+#define PROBES 6 //bits set in a block for each element
 
 typedef struct set{
     int count;
     int length;
     char **data;
+    unsigned *hashes; //hash of each string in data
+    unsigned char *prints; //low byte of each hash, scanned for a match
+    unsigned long long *filter; //blocked Bloom filter of the hashes
+    int blocks; //number of cache lines in filter
+    int removed; //elements removed since the filter was built
+    ARENA *arena; //holds the strings in data
 
 } SET;
 
 /*
- * Search Function: Traverses and looks for elements within a SET *sp.
+ * Block Function (Private): Returns the cache line of the filter that holds the bits for hash h. The line is chosen by the high bits of h times the number of lines, so that any number of lines can be used.
  *
- * Big O Complexity: O(n)
+ * Big O Complexity: O(1)
  *
  */
-static int search(SET *sp, char *elt)
+static unsigned long long *block(SET *sp, unsigned h)
+{
+    return sp->filter + ((unsigned long long) h * sp->blocks >> 32) * (LINE_SIZE / 8);
+}
+
+/*
+ * Mix Function (Private): Returns h scrambled across 64 bits, whose top bits choose the bits to set within a block independently of the block itself.
+ *
+ * Big O Complexity: O(1)
+ *
+ */
+static unsigned long long mix(unsigned h)
+{
+    return (h ^ (unsigned long long) h << 32) * 0x9e3779b97f4a7c15ull;
+}
+
+/*
+ * Add Filter Function (Private): Sets the PROBES bits for hash h, all within one cache line.
+ *
+ * Big O Complexity: O(1)
+ *
+ */
+static void addFilter(SET *sp, unsigned h)
+{
+    unsigned long long *bp = block(sp, h);
+    unsigned long long m = mix(h);
+    int i, bit;
+    for(i = 0; i < PROBES; i++)
+    {
+        bit = m >> (64 - 9 * (i + 1)) & (LINE_SIZE * 8 - 1);
+        bp[bit >> 6] |= 1ull << (bit & 63);
+    }
+}
+
+/*
+ * May Contain Function (Private): Returns false if no element with hash h can be in sp, which is found by loading a single cache line of the filter. Returns true if one might be.
+ *
+ * Big O Complexity: O(1)
+ *
+ */
+static bool mayContain(SET *sp, unsigned h)
+{
+#ifdef NOBLOOM
+    return true;
+#else
+    unsigned long long *bp = block(sp, h);
+    unsigned long long m = mix(h);
+    int i, bit;
+    for(i = 0; i < PROBES; i++)
+    {
+        bit = m >> (64 - 9 * (i + 1)) & (LINE_SIZE * 8 - 1);
+        if((bp[bit >> 6] & 1ull << (bit & 63)) == 0)
+            return false;
+    }
+    return true;
+#endif
+}
+
+/*
+ * Rebuild Filter Function (Private): Clears the filter and sets the bits for the elements in sp again from their hashes, dropping the bits left behind by removed elements.
+ *
+ * Big O Complexity: O(n + m)
+ *
+ */
+static void rebuildFilter(SET *sp)
 {
-    assert(sp != NULL);
     int i;
+    memset(sp->filter, 0, (size_t) sp->blocks * LINE_SIZE);
     for(i = 0; i < sp->count; i++)
     {
-        if(strcmp(elt, sp->data[i]) == 0)
+        addFilter(sp, sp->hashes[i]);
+    }
+    sp->removed = 0;
+}
+
+/*
+ * Search Function: Traverses and looks for elements with hash h within a SET *sp. Unless the filter says the element might be there, sp->data is not looked at. Otherwise sp->prints is scanned WIDTH fingerprints at a time with vector compares (built with -mavx2, 32 at a time, otherwise 16 with SSE2), and only strings whose fingerprint and hash both match are compared, so the scan reads one dense byte per element instead of following a pointer.
+ *
+ * Big O Complexity: O(n), O(1) for most misses
+ *
+ */
+static int search(SET *sp, char *elt, unsigned h)
+{
+    assert(sp != NULL);
+    unsigned char print = h;
+    int i = 0;
+    if(mayContain(sp, h) == false)
+        return -1;
+#if WIDTH > 1
+    unsigned mask;
+#if WIDTH == 32
+    __m256i key = _mm256_set1_epi8(print);
+#else
+    __m128i key = _mm_set1_epi8(print);
+#endif
+    for(; i + WIDTH <= sp->count; i += WIDTH)
+    {
+#if WIDTH == 32
+        mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((__m256i *) (sp->prints + i)), key));
+#else
+        mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((__m128i *) (sp->prints + i)), key));
+#endif
+        while(mask != 0)
+        {
+            int idx = i + __builtin_ctz(mask);
+            if(sp->hashes[idx] == h && strcmp(elt, sp->data[idx]) == 0)
+                return idx;
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for(; i < sp->count; i++)
+    {
+        if(sp->prints[i] == print && sp->hashes[i] == h && strcmp(elt, sp->data[i]) == 0)
         {
             return i;
         }
@@ -45,21 +173,30 @@ SET *createSet(int maxElts)
     sp->length = maxElts;
     sp->count = 0;
     sp->data = malloc(sizeof(char *)*maxElts);
+    sp->hashes = malloc(sizeof(unsigned)*maxElts);
+    sp->prints = malloc(maxElts);
+    sp->blocks = ((long) maxElts * BITS_PER_ELT + LINE_SIZE * 8 - 1) / (LINE_SIZE * 8);
+    sp->filter = aligned_alloc(LINE_SIZE, (size_t) sp->blocks * LINE_SIZE);
+    assert(sp->data != NULL && sp->hashes != NULL && sp->prints != NULL && sp->filter != NULL);
+    memset(sp->filter, 0, (size_t) sp->blocks * LINE_SIZE);
+    sp->removed = 0;
+    sp->arena = createArena();
     return sp;
 }
 
 /*
- * Destroy Set Function: Destroys set beginning with strings of data, deleting sp->data, freeing memory & ending in SET sp.
+ * Destroy Set Function: Destroys set beginning with strings of data, releasing the arena holding them one chunk at a time, deleting sp->data, freeing memory & ending in SET sp.
  *
- * Big O Complexity: O(n)
+ * Big O Complexity: O(c)
  *
  */
 void destroySet(SET *sp)
 {
-    int i;
     assert(sp != NULL);
-    for(i = 0; i < sp->count; i++)
-        free(sp->data[i]);
+    destroyArena(sp->arena);
+    free(sp->filter);
+    free(sp->prints);
+    free(sp->hashes);
     free(sp->data);
     free(sp);
 }
@@ -77,23 +214,28 @@ int numElements(SET *sp)
 }
 
 /*
- * Add Element Function: Checks to see if element is within sp->data, if not, function add element.
+ * Add Element Function: Checks to see if element is within sp->data, if not, function add element and sets its bits in the filter.
  *
- * Big O Complexity: O(n)
+ * Big O Complexity: O(n), O(1) if the filter rules it out
  *
  */
 void addElement(SET *sp, char *elt)
 {
     assert(sp != NULL);
-    if(search(sp, elt) == -1)
+    unsigned h = widehash(elt);
+    if(search(sp, elt, h) == -1)
     {
-        sp->data[sp->count] = strdup(elt);
+        assert(sp->count < sp->length);
+        sp->data[sp->count] = arenaDup(sp->arena, elt);
+        sp->hashes[sp->count] = h;
+        sp->prints[sp->count] = h;
         sp->count += 1;
+        addFilter(sp, h);
     }
 }
 
 /*
- * Remove Element Function: Checks to see if element is within sp->data, if so, function deletes element.
+ * Remove Element Function: Checks to see if element is within sp->data, if so, function deletes element. Its bits cannot be cleared from the filter, since other elements may share them, so once more elements have been removed than are left, about half the bits set are stale and the filter is rebuilt.
  *
  * Big O Complexity: O(n)
  *
@@ -101,26 +243,31 @@ void addElement(SET *sp, char *elt)
 void removeElement(SET *sp, char *elt)
 {
     assert(sp != NULL);
-    int idx = search(sp, elt);
+    int idx = search(sp, elt, widehash(elt));
     if(idx != -1)
     {
-        free(sp->data[idx]);
+        arenaFree(sp->arena, sp->data[idx]);
         sp->data[idx] = sp->data[sp->count -1];
+        sp->hashes[idx] = sp->hashes[sp->count -1];
+        sp->prints[idx] = sp->prints[sp->count -1];
         sp->count -= 1;
+        sp->removed += 1;
+        if(sp->removed > sp->count)
+            rebuildFilter(sp);
     }
 }
 
 /*
  * Find Element Function: Finds element within SET *sp, if that element is found it is returned and throws false if not found.
  *
- * Big O Complexity: O(n)
+ * Big O Complexity: O(n), O(1) if the filter rules it out
  *
  */
 char *findElement(SET *sp, char *elt)
 {
     int idx;
     assert(sp != NULL);
-    idx = search(sp, elt);
+    idx = search(sp, elt, widehash(elt));
     if(idx == -1)
         return NULL;
     return sp->data[idx];
@@ -143,3 +290,19 @@ char **getElements(SET *sp)
     }
     return data;
 }
+
+/*
+ * Visit Elements Function: Calls visit(elt, arg) on each element in SET *sp in place, without copying the array or the strings.
+ *
+ * Big O Complexity: O(n)
+ *
+ */
+void visitElements(SET *sp, void (*visit)(), void *arg)
+{
+    int i;
+    assert(sp != NULL && visit != NULL);
+    for(i = 0; i < sp->count; i++)
+    {
+        (*visit)(sp->data[i], arg);
+    }
+}
@@ -0,0 +1,355 @@
+/*
+ * File:        bench.c
+ *
+ * Description: This file contains the main function for comparing the set
+ *              in table.c, which calls its compare and hash functions
+ *              through pointers, with sets specialized by DEFINE_SET in
+ *              defset.h, which call them directly.
+ *
+ *              The program takes a single file as a command line argument
+ *              and reads all of its words into memory.  It then runs the
+ *              unique and counts workloads several times with each kind of
+ *              set and prints the cycles per word.  Both kinds use strhash
+ *              and strcmp, and tables of the same size, so the difference
+ *              is only in how the functions are called.  Build with
+ *              optimization, e.g., "make CFLAGS='-O2 -Wall -I../../common'",
+ *              for the measurement to mean anything.
+ */
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <time.h>
+# include <assert.h>
+# include "set.h"
+# include "defset.h"
+# include "hash.h"
+
+# if defined(__x86_64__) || defined(__i386__)
+# include <x86intrin.h>
+# define UNIT "cycles"
+# define now() __rdtsc()
+# else
+# define UNIT "ns"
+# define now() nanoseconds()
+# define NANOSECONDS
+# endif
+
+# define ROUNDS 5
+
+struct entry {
+    char *word;
+    int count;
+};
+
+
+/*
+ * Function:    wordHash
+ *
+ * Description: Return a hash value for a string S.  This is strhash from
+ *		hash.c, repeated here so that the compiler can inline it.
+ */
+
+static inline unsigned wordHash(char *s)
+{
+    unsigned hash = 0;
+
+
+    while (*s != '\0')
+	hash = 31 * hash + *s ++;
+
+    return hash;
+}
+
+
+/* The specialized sets: one of strings and one of entries keyed by word. */
+
+# define WORD_HASH(sp, s)	wordHash(s)
+# define WORD_EQUAL(sp, x, y)	(strcmp(x, y) == 0)
+# define ENTRY_HASH(sp, ep)	wordHash((ep)->word)
+# define ENTRY_EQUAL(sp, x, y)	(strcmp((x)->word, (y)->word) == 0)
+
+DEFINE_SET(words, char *, WORD_HASH, WORD_EQUAL)
+DEFINE_SET(entries, struct entry *, ENTRY_HASH, ENTRY_EQUAL)
+
+
+/*
+ * Function:	hashEntry
+ *
+ * Description:	Return a hash value for an entry based on its word.
+ */
+
+static unsigned hashEntry(struct entry *ep)
+{
+    return strhash(ep->word);
+}
+
+
+/*
+ * Function:	compareEntries
+ *
+ * Description:	Compare two entries as in strcmp().
+ */
+
+static int compareEntries(struct entry *ep1, struct entry *ep2)
+{
+    return strcmp(ep1->word, ep2->word);
+}
+
+
+# ifdef NANOSECONDS
+/*
+ * Function:    nanoseconds
+ *
+ * Description: Return the current value of a monotonic clock in
+ *		nanoseconds.
+ */
+
+static unsigned long long nanoseconds(void)
+{
+    struct timespec ts;
+
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+# endif
+
+
+/*
+ * Function:    uniqueGeneric
+ *
+ * Description: Run the unique workload on the N words in WORDS with a
+ *		generic set of LENGTH slots and return the number of
+ *		distinct words.
+ */
+
+static int uniqueGeneric(char **words, int n, int length)
+{
+    SET *sp;
+    int i, count;
+
+
+    sp = createSet(length, strcmp, strhash);
+
+    for (i = 0; i < n; i ++)
+	if (findElement(sp, words[i]) == NULL)
+	    addElement(sp, words[i]);
+
+    count = numElements(sp);
+    destroySet(sp);
+    return count;
+}
+
+
+/*
+ * Function:    uniqueSpecialized
+ *
+ * Description: Run the unique workload on the N words in WORDS with a
+ *		specialized set of LENGTH slots and return the number of
+ *		distinct words.
+ */
+
+static int uniqueSpecialized(char **words, int n, int length)
+{
+    struct words *sp;
+    int i, count;
+
+
+    sp = wordsCreate(length);
+
+    for (i = 0; i < n; i ++)
+	if (wordsFind(sp, words[i]) == NULL)
+	    wordsAdd(sp, words[i]);
+
+    count = wordsCount(sp);
+    wordsDestroy(sp);
+    return count;
+}
+
+
+/*
+ * Function:    countsGeneric
+ *
+ * Description: Run the counts workload on the N words in WORDS with a
+ *		generic set of LENGTH slots, using ENTRIES for storage, and
+ *		return the number of distinct words.
+ */
+
+static int countsGeneric(char **words, int n, int length,
+	struct entry *entries)
+{
+    struct entry e, *ep;
+    SET *sp;
+    int i, used, count;
+
+
+    used = 0;
+    sp = createSet(length, compareEntries, hashEntry);
+
+    for (i = 0; i < n; i ++) {
+	e.word = words[i];
+	ep = findElement(sp, &e);
+
+	if (ep == NULL) {
+	    ep = &entries[used ++];
+	    ep->word = words[i];
+	    ep->count = 1;
+	    addElement(sp, ep);
+	} else
+	    ep->count ++;
+    }
+
+    count = numElements(sp);
+    destroySet(sp);
+    return count;
+}
+
+
+/*
+ * Function:    countsSpecialized
+ *
+ * Description: Run the counts workload on the N words in WORDS with a
+ *		specialized set of LENGTH slots, using ENTRIES for storage,
+ *		and return the number of distinct words.
+ */
+
+static int countsSpecialized(char **words, int n, int length,
+	struct entry *entries)
+{
+    struct entry e, **epp, *ep;
+    struct entries *sp;
+    int i, used, count;
+
+
+    used = 0;
+    sp = entriesCreate(length);
+
+    for (i = 0; i < n; i ++) {
+	e.word = words[i];
+	epp = entriesFind(sp, &e);
+
+	if (epp == NULL) {
+	    ep = &entries[used ++];
+	    ep->word = words[i];
+	    ep->count = 1;
+	    entriesAdd(sp, ep);
+	} else
+	    (*epp)->count ++;
+    }
+
+    count = entriesCount(sp);
+    entriesDestroy(sp);
+    return count;
+}
+
+
+/*
+ * Function:    main
+ *
+ * Description: Driver function for the benchmark.
+ */
+
+int main(int argc, char *argv[])
+{
+    FILE *fp;
+    char buffer[BUFSIZ], **words;
+    unsigned long long start, generic, specialized;
+    struct entry *entries;
+    int i, n, size, length, distinct, count, round;
+
+
+    /* Check usage and open the file. */
+
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s file\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    if ((fp = fopen(argv[1], "r")) == NULL) {
+        fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[1]);
+        exit(EXIT_FAILURE);
+    }
+
+
+    /* Read all of the words into memory. */
+
+    n = 0;
+    size = 1024;
+    words = malloc(sizeof(char *) * size);
+    assert(words != NULL);
+
+    while (fscanf(fp, "%s", buffer) == 1) {
+	if (n == size) {
+	    size *= 2;
+	    words = realloc(words, sizeof(char *) * size);
+	    assert(words != NULL);
+	}
+
+	words[n] = strdup(buffer);
+	assert(words[n] != NULL);
+	n ++;
+    }
+
+    fclose(fp);
+
+    if (n == 0) {
+	fprintf(stderr, "%s: no words in %s\n", argv[0], argv[1]);
+	exit(EXIT_FAILURE);
+    }
+
+    entries = malloc(sizeof(struct entry) * n);
+    assert(entries != NULL);
+
+
+    /* Size the tables for a load factor of one half. */
+
+    distinct = uniqueSpecialized(words, n, n + 1);
+    length = 2 * distinct + 1;
+    printf("%d words, %d distinct\n\n", n, distinct);
+    printf("workload  generic %-6s specialized %-6s\n", UNIT, UNIT);
+
+
+    /* Time each workload with each kind of set. */
+
+    generic = specialized = 0;
+
+    for (round = 0; round < ROUNDS; round ++) {
+	start = now();
+	count = uniqueGeneric(words, n, length);
+	generic += now() - start;
+	assert(count == distinct);
+
+	start = now();
+	count = uniqueSpecialized(words, n, length);
+	specialized += now() - start;
+	assert(count == distinct);
+    }
+
+    printf("unique   %15.2f %19.2f\n", (double) generic / ROUNDS / n,
+	(double) specialized / ROUNDS / n);
+
+    generic = specialized = 0;
+
+    for (round = 0; round < ROUNDS; round ++) {
+	start = now();
+	count = countsGeneric(words, n, length, entries);
+	generic += now() - start;
+	assert(count == distinct);
+
+	start = now();
+	count = countsSpecialized(words, n, length, entries);
+	specialized += now() - start;
+	assert(count == distinct);
+    }
+
+    printf("counts   %15.2f %19.2f\n", (double) generic / ROUNDS / n,
+	(double) specialized / ROUNDS / n);
+
+    for (i = 0; i < n; i ++)
+	free(words[i]);
+
+    free(entries);
+    free(words);
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,240 @@
+/*
+ * File:        countmap.c
+ *
+ * Description: This file contains the public and private function and type
+ *              definitions for a map from words to counts that may be
+ *              shared by several threads.
+ *
+ *              Each shard is a set of counts generated by DEFINE_SET in
+ *              defset.h, protected by a mutex.  The counts are kept in the
+ *              table itself rather than allocated one at a time, and the
+ *              words are copied into an arena belonging to the shard, so
+ *              counting a new word allocates nothing in the common case and
+ *              destroying the map frees each shard's memory in a few
+ *              large blocks.  A shard doubles in size whenever it becomes
+ *              half full.
+ *
+ *              The shard is chosen by the top bits of the word's hash value
+ *              after a multiplication by the golden ratio, which leaves the
+ *              low bits used by the shard's table unrelated to the shard.
+ *              The hash value is computed once and passed to the shard.
+ */
+
+# include <stdlib.h>
+# include <string.h>
+# include <stdbool.h>
+# include <pthread.h>
+# include <assert.h>
+# include "countmap.h"
+# include "defset.h"
+# include "arena.h"
+
+# define INITIAL 1024
+
+struct words;
+static unsigned hashCount(struct words *tp, COUNT c);
+static int equalCounts(struct words *tp, COUNT x, COUNT y);
+
+DEFINE_SET(words, COUNT, hashCount, equalCounts)
+
+typedef struct shard {
+    struct words *words;	/* counts of words in shard    */
+    ARENA *arena;		/* copies of words in shard    */
+    pthread_mutex_t lock;	/* held while using the shard  */
+} SHARD;
+
+struct countmap {
+    int bits;			/* log2 of the number of shards */
+    SHARD *shards;		/* array of shards             */
+    HASHFN hash;		/* hash function               */
+};
+
+
+/*
+ * Function:    hashCount
+ *
+ * Description: Return the hash value of a count.  This is never called,
+ *		since the hash value is always passed to wordsInsert, but the
+ *		other generated functions need it.
+ */
+
+static unsigned hashCount(struct words *tp, COUNT c)
+{
+    return strhash(c.word);
+}
+
+
+/*
+ * Function:    equalCounts
+ *
+ * Description: Return whether counts X and Y are for the same word.
+ */
+
+static int equalCounts(struct words *tp, COUNT x, COUNT y)
+{
+    return strcmp(x.word, y.word) == 0;
+}
+
+
+/*
+ * Function:    createCountMap
+ *
+ * Complexity:  O(s)
+ *
+ * Description: Return a pointer to a new, empty map with SHARDS shards,
+ *		which must be a power of two, using the hash function HASH.
+ */
+
+COUNTMAP *createCountMap(int shards, HASHFN hash)
+{
+    COUNTMAP *mp;
+    int i;
+
+
+    assert(shards > 0 && (shards & (shards - 1)) == 0 && hash != NULL);
+
+    mp = malloc(sizeof(COUNTMAP));
+    assert(mp != NULL);
+
+    mp->shards = malloc(sizeof(SHARD) * shards);
+    assert(mp->shards != NULL);
+
+    for (mp->bits = 0; (1 << mp->bits) < shards; mp->bits ++)
+	;
+
+    for (i = 0; i < shards; i ++) {
+	mp->shards[i].words = wordsCreate(INITIAL);
+	mp->shards[i].arena = createArena();
+	pthread_mutex_init(&mp->shards[i].lock, NULL);
+    }
+
+    mp->hash = hash;
+    return mp;
+}
+
+
+/*
+ * Function:    destroyCountMap
+ *
+ * Complexity:  O(s)
+ *
+ * Description: Deallocate memory associated with the map pointed to by
+ *		MP, including its copies of the words.
+ */
+
+void destroyCountMap(COUNTMAP *mp)
+{
+    int i;
+
+
+    assert(mp != NULL);
+
+    for (i = 0; i < 1 << mp->bits; i ++) {
+	wordsDestroy(mp->shards[i].words);
+	destroyArena(mp->shards[i].arena);
+	pthread_mutex_destroy(&mp->shards[i].lock);
+    }
+
+    free(mp->shards);
+    free(mp);
+}
+
+
+/*
+ * Function:    countWord
+ *
+ * Complexity:  O(1) average case
+ *
+ * Description: Add N to the count of WORD in the map pointed to by MP,
+ *		copying WORD if it is new.
+ */
+
+void countWord(COUNTMAP *mp, char *word, long n)
+{
+    unsigned hash;
+    COUNT c, *cp;
+    SHARD *shp;
+    bool found;
+    int i;
+
+
+    assert(mp != NULL && word != NULL);
+
+    hash = (*mp->hash)(word);
+    i = mp->bits > 0 ? hash * 0x9e3779b9u >> (32 - mp->bits) : 0;
+    shp = &mp->shards[i];
+
+    c.word = word;
+    c.count = 0;
+
+    pthread_mutex_lock(&shp->lock);
+
+    if ((shp->words->count + 1) * 2 > shp->words->length)
+	wordsResize(shp->words, shp->words->length * 2);
+
+    cp = wordsInsert(shp->words, c, hash, &found);
+
+    if (!found)
+	cp->word = arenaDup(shp->arena, word);
+
+    cp->count += n;
+    pthread_mutex_unlock(&shp->lock);
+}
+
+
+/*
+ * Function:    numWords
+ *
+ * Complexity:  O(s)
+ *
+ * Description: Return the number of distinct words in the map pointed to
+ *		by MP.
+ */
+
+int numWords(COUNTMAP *mp)
+{
+    int i, count;
+
+
+    assert(mp != NULL);
+
+    for (i = count = 0; i < 1 << mp->bits; i ++) {
+	pthread_mutex_lock(&mp->shards[i].lock);
+	count += wordsCount(mp->shards[i].words);
+	pthread_mutex_unlock(&mp->shards[i].lock);
+    }
+
+    return count;
+}
+
+
+/*
+ * Function:    getCounts
+ *
+ * Complexity:  O(m)
+ *
+ * Description: Allocate and return an array of the counts in the map
+ *		pointed to by MP.  The words belong to the map.
+ */
+
+COUNT *getCounts(COUNTMAP *mp)
+{
+    COUNT *counts, *elts;
+    int i, n, count;
+
+
+    assert(mp != NULL);
+
+    counts = malloc(sizeof(COUNT) * (numWords(mp) + 1));
+    assert(counts != NULL);
+
+    for (i = n = 0; i < 1 << mp->bits; i ++) {
+	elts = wordsElements(mp->shards[i].words);
+	count = wordsCount(mp->shards[i].words);
+	memcpy(counts + n, elts, sizeof(COUNT) * count);
+	n += count;
+	free(elts);
+    }
+
+    return counts;
+}
@@ -0,0 +1,39 @@
+/*
+ * File:        countmap.h
+ *
+ * Description: This file contains the public function and type
+ *              declarations for a map from words to counts that may be
+ *              shared by several threads.  The map is divided into shards,
+ *              each with its own lock, and a word's hash value selects its
+ *              shard, so threads counting different words seldom wait for
+ *              each other.
+ *
+ *              countWord and numWords may be called concurrently from any
+ *              number of threads.  createCountMap, destroyCountMap, and
+ *              getCounts may not be called while any other operation is
+ *              in progress.
+ */
+
+# ifndef COUNTMAP_H
+# define COUNTMAP_H
+
+# include "hash.h"
+
+typedef struct countmap COUNTMAP;
+
+typedef struct {
+    char *word;
+    long count;
+} COUNT;
+
+COUNTMAP *createCountMap(int shards, HASHFN hash);
+
+void destroyCountMap(COUNTMAP *mp);
+
+void countWord(COUNTMAP *mp, char *word, long n);
+
+int numWords(COUNTMAP *mp);
+
+COUNT *getCounts(COUNTMAP *mp);
+
+# endif /* COUNTMAP_H */
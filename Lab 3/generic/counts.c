@@ -15,6 +15,7 @@
 # include <string.h>
 # include <assert.h>
 # include "set.h"
+# include "hash.h"
 
 struct entry {
     char *word;
@@ -27,22 +28,9 @@ struct entry {
 # define MAX_SIZE 18000
 
 
-/*
- * Function:    strhash
- *
- * Description: Return a hash value for a string S.
- */
-
-static unsigned strhash(char *s)
-{
-    unsigned hash = 0;
+/* The hash function for words, selected by the HASH environment variable. */
 
-
-    while (*s != '\0')
-        hash = 31 * hash + *s ++;
-
-    return hash;
-}
+static HASHFN hash;
 
 
 /*
@@ -53,7 +41,7 @@ static unsigned strhash(char *s)
 
 static unsigned hashEntry(struct entry *ep)
 {
-    return strhash(ep->word);
+    return (*hash)(ep->word);
 }
 
 
@@ -69,6 +57,21 @@ static int compareEntries(struct entry *ep1, struct entry *ep2)
 }
 
 
+/*
+ * Function:    printEntry
+ *
+ * Description: Print the word and count of the entry pointed to by EP,
+ *		and then deallocate it.
+ */
+
+static void printEntry(struct entry *ep, void *arg)
+{
+    printf("%s: %d\n", ep->word, ep->count);
+    free(ep->word);
+    free(ep);
+}
+
+
 /*
  * Function:    main
  *
@@ -79,9 +82,8 @@ int main(int argc, char *argv[])
 {
     FILE *fp;
     char buffer[BUFSIZ];
-    struct entry e, *ep, **entries;
+    struct entry e, *ep;
     SET *counts;
-    int i;
 
 
     /* Check usage and open the file. */
@@ -96,6 +98,11 @@ int main(int argc, char *argv[])
         exit(EXIT_FAILURE);
     }
 
+    if ((hash = findHash(getenv("HASH"))) == NULL) {
+	fprintf(stderr, "%s: unknown hash %s\n", argv[0], getenv("HASH"));
+	exit(EXIT_FAILURE);
+    }
+
 
     /* Increment the count on each word read. */
 
@@ -122,16 +129,7 @@ int main(int argc, char *argv[])
 
     /* Print out the counts for each word. */
 
-    entries = getElements(counts);
-
-    for (i = 0; i < numElements(counts); i ++) {
-	printf("%s: %d\n", entries[i]->word, entries[i]->count);
-	free(entries[i]->word);
-	free(entries[i]);
-    }
-
-    free(entries);
-
+    visitElements(counts, printEntry, NULL);
     destroySet(counts);
     exit(EXIT_SUCCESS);
 }
@@ -0,0 +1,266 @@
+/*
+ * File:        defset.h
+ *
+ * Description: This file contains a generator for sets specialized to a
+ *              single element type.  The set in table.c calls its compare
+ *              and hash functions through pointers on every probe, which
+ *              prevents the compiler from inlining them.  A set defined
+ *              here calls them directly, so they may be inlined at each
+ *              call site.
+ *
+ *              DEFINE_SET(name, type, hashfn, eqfn) defines struct name
+ *              and the following static functions, using the same linear
+ *              probing with deleted markers and cached hash values as
+ *              table.c:
+ *
+ *                  struct name *name##Create(int maxElts)
+ *                  void name##Destroy(struct name *sp)
+ *                  int name##Count(struct name *sp)
+ *                  bool name##Add(struct name *sp, type elt)
+ *                  bool name##Remove(struct name *sp, type elt)
+ *                  type *name##Find(struct name *sp, type elt)
+ *                  type *name##Elements(struct name *sp)
+ *                  void name##Visit(struct name *sp, void (*visit)(),
+ *                      void *arg)
+ *                  type *name##Insert(struct name *sp, type elt,
+ *                      unsigned hash, bool *found)
+ *                  void name##Resize(struct name *sp, int length)
+ *
+ *              hashfn(sp, elt) must return an unsigned hash value for elt
+ *              and eqfn(sp, x, y) must return nonzero if x and y are
+ *              equal.  Either may be a function or a macro, and both are
+ *              passed the set so that an instantiation can keep extra
+ *              state in a structure containing it.  name##Add and
+ *              name##Remove return whether the set was changed.
+ *              name##Find returns the slot holding the element or NULL,
+ *              and name##Elements returns an allocated array of the
+ *              elements.  name##Visit calls visit(elt, arg) on each element
+ *              in place instead, so nothing is allocated or copied.
+ *
+ *              name##Insert takes the hash value of elt already computed,
+ *              adds elt if no equal element is present, and returns the
+ *              slot holding the element either way, with found telling
+ *              which.  The caller may then update the element in place.
+ *              name##Resize moves the elements to a table of length slots,
+ *              using their cached hash values and dropping deleted
+ *              markers.  The table never grows on its own.
+ */
+
+# ifndef DEFSET_H
+# define DEFSET_H
+
+# include <stdlib.h>
+# include <stdbool.h>
+# include <assert.h>
+
+# define SET_EMPTY   0
+# define SET_DELETED 1
+# define SET_FILLED  2
+
+# define DEFINE_SET(name, type, hashfn, eqfn)				     \
+									     \
+struct name {								     \
+    int count;								     \
+    int length;								     \
+    type *data;								     \
+    unsigned *hashes;							     \
+    char *flags;							     \
+};									     \
+									     \
+static inline struct name *name##Create(int maxElts)			     \
+{									     \
+    struct name *sp;							     \
+									     \
+									     \
+    assert(maxElts > 0);						     \
+    sp = malloc(sizeof(struct name));					     \
+    assert(sp != NULL);							     \
+									     \
+    sp->count = 0;							     \
+    sp->length = maxElts;						     \
+    sp->data = malloc(sizeof(type) * maxElts);				     \
+    sp->hashes = malloc(sizeof(unsigned) * maxElts);			     \
+    sp->flags = calloc(maxElts, sizeof(char));				     \
+    assert(sp->data != NULL && sp->hashes != NULL && sp->flags != NULL);     \
+    return sp;								     \
+}									     \
+									     \
+static inline void name##Destroy(struct name *sp)			     \
+{									     \
+    assert(sp != NULL);							     \
+    free(sp->flags);							     \
+    free(sp->hashes);							     \
+    free(sp->data);							     \
+    free(sp);								     \
+}									     \
+									     \
+static inline int name##Count(struct name *sp)				     \
+{									     \
+    assert(sp != NULL);							     \
+    return sp->count;							     \
+}									     \
+									     \
+static inline int name##Search(struct name *sp, type elt, unsigned h,	     \
+	bool *found)							     \
+{									     \
+    int i, idx, vacant;							     \
+									     \
+									     \
+    vacant = -1;							     \
+    idx = h % sp->length;						     \
+									     \
+    for (i = 0; i < sp->length; i ++) {					     \
+	if (sp->flags[idx] == SET_EMPTY) {				     \
+	    *found = false;						     \
+	    return vacant != -1 ? vacant : idx;				     \
+	}								     \
+									     \
+	if (sp->flags[idx] == SET_DELETED) {				     \
+	    if (vacant == -1)						     \
+		vacant = idx;						     \
+	} else if (sp->hashes[idx] == h && eqfn(sp, elt, sp->data[idx])) {   \
+	    *found = true;						     \
+	    return idx;							     \
+	}								     \
+									     \
+	if (++ idx == sp->length)					     \
+	    idx = 0;							     \
+    }									     \
+									     \
+    *found = false;							     \
+    return vacant;							     \
+}									     \
+									     \
+static inline bool name##Add(struct name *sp, type elt)			     \
+{									     \
+    unsigned h;								     \
+    bool found;								     \
+    int idx;								     \
+									     \
+									     \
+    assert(sp != NULL);							     \
+    h = hashfn(sp, elt);						     \
+    idx = name##Search(sp, elt, h, &found);				     \
+									     \
+    if (found)								     \
+	return false;							     \
+									     \
+    assert(idx != -1);							     \
+    sp->data[idx] = elt;						     \
+    sp->hashes[idx] = h;						     \
+    sp->flags[idx] = SET_FILLED;					     \
+    sp->count ++;							     \
+    return true;							     \
+}									     \
+									     \
+static inline bool name##Remove(struct name *sp, type elt)		     \
+{									     \
+    bool found;								     \
+    int idx;								     \
+									     \
+									     \
+    assert(sp != NULL);							     \
+    idx = name##Search(sp, elt, hashfn(sp, elt), &found);		     \
+									     \
+    if (!found)								     \
+	return false;							     \
+									     \
+    sp->flags[idx] = SET_DELETED;					     \
+    sp->count --;							     \
+    return true;							     \
+}									     \
+									     \
+static inline type *name##Find(struct name *sp, type elt)		     \
+{									     \
+    bool found;								     \
+    int idx;								     \
+									     \
+									     \
+    assert(sp != NULL);							     \
+    idx = name##Search(sp, elt, hashfn(sp, elt), &found);		     \
+    return found ? &sp->data[idx] : NULL;				     \
+}									     \
+									     \
+static inline type *name##Elements(struct name *sp)			     \
+{									     \
+    type *elts;								     \
+    int i, j;								     \
+									     \
+									     \
+    assert(sp != NULL);							     \
+    elts = malloc(sizeof(type) * (sp->count > 0 ? sp->count : 1));	     \
+    assert(elts != NULL);						     \
+									     \
+    for (i = j = 0; i < sp->length; i ++)				     \
+	if (sp->flags[i] == SET_FILLED)					     \
+	    elts[j ++] = sp->data[i];					     \
+									     \
+    return elts;							     \
+}									     \
+									     \
+static inline void name##Visit(struct name *sp, void (*visit)(), void *arg)  \
+{									     \
+    int i;								     \
+									     \
+									     \
+    assert(sp != NULL && visit != NULL);				     \
+									     \
+    for (i = 0; i < sp->length; i ++)					     \
+	if (sp->flags[i] == SET_FILLED)					     \
+	    (*visit)(sp->data[i], arg);					     \
+}									     \
+									     \
+static inline type *name##Insert(struct name *sp, type elt, unsigned h,	     \
+	bool *found)							     \
+{									     \
+    int idx;								     \
+									     \
+									     \
+    assert(sp != NULL && found != NULL);				     \
+    idx = name##Search(sp, elt, h, found);				     \
+									     \
+    if (!*found) {							     \
+	assert(idx != -1);						     \
+	sp->data[idx] = elt;						     \
+	sp->hashes[idx] = h;						     \
+	sp->flags[idx] = SET_FILLED;					     \
+	sp->count ++;							     \
+    }									     \
+									     \
+    return &sp->data[idx];						     \
+}									     \
+									     \
+static inline void name##Resize(struct name *sp, int length)		     \
+{									     \
+    struct name old;							     \
+    int i, idx;								     \
+									     \
+									     \
+    assert(sp != NULL && length > sp->count);				     \
+    old = *sp;								     \
+									     \
+    sp->length = length;						     \
+    sp->data = malloc(sizeof(type) * length);				     \
+    sp->hashes = malloc(sizeof(unsigned) * length);			     \
+    sp->flags = calloc(length, sizeof(char));				     \
+    assert(sp->data != NULL && sp->hashes != NULL && sp->flags != NULL);     \
+									     \
+    for (i = 0; i < old.length; i ++)					     \
+	if (old.flags[i] == SET_FILLED) {				     \
+	    idx = old.hashes[i] % length;				     \
+									     \
+	    while (sp->flags[idx] != SET_EMPTY)				     \
+		if (++ idx == length)					     \
+		    idx = 0;						     \
+									     \
+	    sp->data[idx] = old.data[i];				     \
+	    sp->hashes[idx] = old.hashes[i];				     \
+	    sp->flags[idx] = SET_FILLED;				     \
+	}								     \
+									     \
+    free(old.flags);							     \
+    free(old.hashes);							     \
+    free(old.data);							     \
+}
+
+# endif /* DEFSET_H */
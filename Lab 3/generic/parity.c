@@ -16,6 +16,7 @@
 # include <stdlib.h>
 # include <string.h>
 # include "set.h"
+# include "hash.h"
 
 
 /* This is sufficient for the test cases in /scratch/coen12. */
@@ -23,24 +24,6 @@
 # define MAX_SIZE 18000
 
 
-/*
- * Function:    strhash
- *
- * Description: Return a hash value for a string S.
- */
-
-static unsigned strhash(char *s)
-{
-    unsigned hash = 0;
-
-
-    while (*s != '\0')
-        hash = 31 * hash + *s ++;
-
-    return hash;
-}
-
-
 /*
  * Function:    main
  *
@@ -52,6 +35,7 @@ int main(int argc, char *argv[])
     FILE *fp;
     char buffer[BUFSIZ], *word;
     SET *odd;
+    HASHFN hash;
     int words;
 
 
@@ -67,11 +51,16 @@ int main(int argc, char *argv[])
         exit(EXIT_FAILURE);
     }
 
+    if ((hash = findHash(getenv("HASH"))) == NULL) {
+	fprintf(stderr, "%s: unknown hash %s\n", argv[0], getenv("HASH"));
+	exit(EXIT_FAILURE);
+    }
+
 
     /* Insert or delete words to compute their parity. */
 
     words = 0;
-    odd = createSet(MAX_SIZE, strcmp, strhash);
+    odd = createSet(MAX_SIZE, strcmp, hash);
 
     while (fscanf(fp, "%s", buffer) == 1) {
         words ++;
@@ -0,0 +1,184 @@
+/*
+ * File:        pcounts.c
+ *
+ * Description: This file contains the main function for counting words
+ *              with several threads.
+ *
+ *              The program takes one file as a command line argument and
+ *              prints the number of times each word appears in it, as
+ *              counts does, though not necessarily in the same order.  The
+ *              file is mapped into memory and divided at whitespace into
+ *              one part per thread, and each thread counts the words of
+ *              its part in a single sharded count map.  The number of
+ *              threads is given with -t and defaults to the number of
+ *              processors.
+ */
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <ctype.h>
+# include <unistd.h>
+# include <fcntl.h>
+# include <pthread.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <assert.h>
+# include "countmap.h"
+
+# define SHARDS 64
+
+struct part {
+    COUNTMAP *map;		/* map shared by all threads   */
+    char *start;		/* first character of the part */
+    char *end;			/* one past the last character */
+};
+
+
+/*
+ * Function:    countPart
+ *
+ * Description: Count each word of the part pointed to by ARG in its map.
+ *		As with fscanf, a word is a run of characters other than
+ *		whitespace, and is truncated to fit in a buffer.
+ */
+
+static void *countPart(void *arg)
+{
+    struct part *pp = arg;
+    char buffer[BUFSIZ], *p;
+    int length;
+
+
+    p = pp->start;
+
+    while (p < pp->end) {
+	while (p < pp->end && isspace((unsigned char) *p))
+	    p ++;
+
+	if (p == pp->end)
+	    break;
+
+	length = 0;
+
+	while (p < pp->end && !isspace((unsigned char) *p)) {
+	    if (length < BUFSIZ - 1)
+		buffer[length ++] = *p;
+
+	    p ++;
+	}
+
+	buffer[length] = '\0';
+	countWord(pp->map, buffer, 1);
+    }
+
+    return NULL;
+}
+
+
+/*
+ * Function:    main
+ *
+ * Description: Driver function for the test application.
+ */
+
+int main(int argc, char *argv[])
+{
+    int fd, c, i, n, nthreads;
+    struct part *parts;
+    pthread_t *threads;
+    char *text, *p, *end;
+    COUNTMAP *map;
+    COUNT *counts;
+    struct stat st;
+    HASHFN hash;
+    long size;
+
+
+    /* Check usage and open the file. */
+
+    nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+
+    while ((c = getopt(argc, argv, "t:")) != -1)
+	nthreads = c == 't' ? atoi(optarg) : 0;
+
+    if (nthreads < 1 || argc - optind != 1) {
+	fprintf(stderr, "usage: %s [-t threads] file\n", argv[0]);
+	exit(EXIT_FAILURE);
+    }
+
+    if ((fd = open(argv[optind], O_RDONLY)) == -1 || fstat(fd, &st) == -1) {
+	fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[optind]);
+	exit(EXIT_FAILURE);
+    }
+
+    if ((hash = findHash(getenv("HASH"))) == NULL) {
+	fprintf(stderr, "%s: unknown hash %s\n", argv[0], getenv("HASH"));
+	exit(EXIT_FAILURE);
+    }
+
+
+    /* Map the file into memory. */
+
+    size = st.st_size;
+    text = "";
+
+    if (size > 0) {
+	text = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	assert(text != MAP_FAILED);
+    }
+
+    close(fd);
+
+
+    /* Count the words of each part in its own thread. */
+
+    map = createCountMap(SHARDS, hash);
+    threads = malloc(sizeof(pthread_t) * nthreads);
+    parts = malloc(sizeof(struct part) * nthreads);
+    assert(threads != NULL && parts != NULL);
+
+    p = text;
+    end = text + size;
+
+    for (i = 0; i < nthreads; i ++) {
+	parts[i].map = map;
+	parts[i].start = p;
+	p = i < nthreads - 1 ? text + size * (i + 1) / nthreads : end;
+
+	if (p < parts[i].start)
+	    p = parts[i].start;
+
+	while (p < end && !isspace((unsigned char) *p))
+	    p ++;
+
+	parts[i].end = p;
+
+	if (pthread_create(&threads[i], NULL, countPart, &parts[i]) != 0) {
+	    fprintf(stderr, "%s: cannot create thread\n", argv[0]);
+	    exit(EXIT_FAILURE);
+	}
+    }
+
+    for (i = 0; i < nthreads; i ++)
+	pthread_join(threads[i], NULL);
+
+
+    /* Print out the counts for each word. */
+
+    counts = getCounts(map);
+    n = numWords(map);
+
+    for (i = 0; i < n; i ++)
+	printf("%s: %ld\n", counts[i].word, counts[i].count);
+
+    free(counts);
+    free(parts);
+    free(threads);
+    destroyCountMap(map);
+
+    if (size > 0)
+	munmap(text, size);
+
+    exit(EXIT_SUCCESS);
+}
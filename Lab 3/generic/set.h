@@ -28,4 +28,6 @@ void *findElement(SET *sp, void *elt);
 
 void *getElements(SET *sp);
 
+void visitElements(SET *sp, void (*visit)(), void *arg);
+
 # endif /* SET_H */
@@ -5,7 +5,7 @@
  *
  * File: table.c (generic)
  *
- * Description: This file defines a struct "SET" and implements functions (creating, destroying the set, adding and removing elements & searching)
+ * Description: This file defines a struct "SET" and implements functions (creating, destroying the set, adding and removing elements & searching). The table itself is generated by DEFINE_SET in defset.h, with hash and compare called through the pointers stored in SET.
  */
 #include <stdio.h>
 #include <stdlib.h>
@@ -13,92 +13,57 @@
 #include <stdbool.h>
 #include <assert.h>
 #include "set.h"
+#include "probe.h"
+#include "defset.h"
 
-#define FILLED 2
-#define DELETED 1
-#define EMPTY 0
+struct table;
+static unsigned hashElt(struct table *tp, void *elt);
+static int equalElts(struct table *tp, void *x, void *y);
+
+DEFINE_SET(table, void *, hashElt, equalElts)
 
 typedef struct set{
-	int count;
-	int length;
-	char **data;
-	char *flag;
+	struct table table; //must be first, so a pointer to the table is a pointer to the set
 	int (*compare)();
 	unsigned (*hash)();
 
 } SET;
 
 /*
- * Create Set Function: Creates stucture set called sp with variables length, count, and array data.
+ * Hash Elt Function: Calls the hash function of the set holding tp.
  *
  * Big O-Notation: O(1)
  */
-SET *createSet(int maxElts, int (*compare)(), unsigned (*hash)())
+static unsigned hashElt(struct table *tp, void *elt)
 {
-	int i;
-	SET *sp = malloc(sizeof(SET));
-	assert(sp != NULL);
-	sp->length = maxElts;
-	sp->count = 0;
-	sp->data = malloc(sizeof(char *)*maxElts);
-	sp->flag = malloc(sizeof(char )*maxElts);
-	sp->compare = compare;
-	sp->hash = hash;
-	for(i = 0; i < maxElts; i++)
-	{
-		sp->flag[i] = 0;
-	}
-	return sp;
+	return (*((SET *) tp)->hash)(elt);
 }
 
 /*
- * Search Function: Retrieves elements and searches for elements within sp->data, if element does not exist, function returns false & returns true and the index of elements if the element does exist.
+ * Equal Elts Function: Calls the compare function of the set holding tp and returns whether x and y are equal.
  *
- *Big O-Notation: O(m)
+ * Big O-Notation: O(1)
  */
-int search(SET *sp, char *elt, bool *found)
+static int equalElts(struct table *tp, void *x, void *y)
 {
-	assert(elt != NULL && sp != NULL && found !=NULL);
-	int idx;
-	int start;
-	int Bmark = 0;
-	int flag = 0;
-	idx = (*sp->hash)(elt) % (sp->length);
-	start = idx;
-	idx++;
-	idx = idx % sp->length;
-	while(idx != start)
-	{
-		if(sp ->flag[idx] == 0)
-		{
-			if(flag == 0)
-			{
-				*found = false;
-				return idx;
-			}
-			break;
-		}
-		else if(sp->flag[idx] == 2)
-		{
-			if((sp->compare)(elt, sp->data[idx]) == 0)
-			{
-				*found = true;
-				return idx;
-			}
-		}
-		else //sp->flag[i] == 1
-		{
-			if(flag == 0)
-			{
-				flag = 1;
-				Bmark = idx;
-			}
-		}
-		idx++;
-		idx = idx % sp->length;
-	}
-	*found = false;
-	return Bmark;
+	return (*((SET *) tp)->compare)(x, y) == 0;
+}
+
+/*
+ * Create Set Function: Creates stucture set called sp with a table of maxElts slots and the given compare and hash functions.
+ *
+ * Big O-Notation: O(m)
+ */
+SET *createSet(int maxElts, int (*compare)(), unsigned (*hash)())
+{
+	SET *sp = malloc(sizeof(SET));
+	assert(sp != NULL);
+	struct table *tp = tableCreate(maxElts);
+	sp->table = *tp;
+	free(tp);
+	sp->compare = compare;
+	sp->hash = hash;
+	return sp;
 }
 
 /*
@@ -109,8 +74,9 @@ int search(SET *sp, char *elt, bool *found)
 void destroySet(SET *sp) //Frees all pointers in SET O(1)
 {
 	assert(sp != NULL);
-	free(sp->flag);
-	free(sp->data);
+	free(sp->table.flags);
+	free(sp->table.hashes);
+	free(sp->table.data);
 	free(sp);
 }
 
@@ -122,11 +88,11 @@ void destroySet(SET *sp) //Frees all pointers in SET O(1)
 int numElements(SET *sp)
 {
 	assert(sp != NULL);
-	return sp->count;
+	return tableCount(&sp->table);
 }
 
 /*
- * Add Element Function: Adds elements to sp->data if elements is not found.
+ * Add Element Function: Adds elements to the table if elements is not found.
  *
  * Big O-Notation: O(m)
  */
@@ -134,19 +100,11 @@ void addElement(SET *sp, void *elt)
 {
 	assert(sp != NULL);
 	assert(elt != NULL);
-	bool found;
-	int idx;
-	idx = search(sp, elt, &found);
-	if(found == false)
-	{
-		sp->data[idx] = elt;
-		sp->flag[idx] = 2;
-		sp->count += 1;
-	}
+	tableAdd(&sp->table, elt);
 }
 
 /*
- * Remove Element Function: Removes element within sp->data if element is found.
+ * Remove Element Function: Removes element within the table if element is found.
  *
  * Big O-Notation: O(m)
  */
@@ -154,14 +112,7 @@ void removeElement(SET *sp, void *elt)
 {
 	assert(sp != NULL);
 	assert(elt != NULL);
-	bool found;
-	int idx;
-	idx = search(sp, elt, &found);
-	if(found == true)
-	{
-		sp->flag[idx] = 1;
-		sp->count -= 1;
-	}
+	tableRemove(&sp->table, elt);
 }
 
 /*
@@ -173,32 +124,69 @@ void *findElement(SET *sp, void *elt)
 {
 	assert(sp != NULL);
 	assert(elt != NULL);
-	bool found;
-	int idx;
-	idx = search(sp, elt, &found);
-	if(found == false)
+	void **slot = tableFind(&sp->table, elt);
+	if(slot == NULL)
 		return NULL;
-	return sp->data[idx];
+	return *slot;
 }
 
 /*
- * Get Elements Function: Creates, copies, and returns only the filled data within sp->data.
+ * Get Elements Function: Creates, copies, and returns only the filled data within the table.
  *
  * Big O-Notation: O(m)
  */
 void *getElements(SET *sp)
 {
-	int i;
-	int j;
 	assert(sp != NULL);
-	char **data = malloc(sizeof(char *)*(sp->count));
-	for(i = 0, j = 0; i < sp->length; i++)
+	return tableElements(&sp->table);
+}
+
+/*
+ * Visit Elements Function: Calls visit(elt, arg) on each element in the table in place, so that nothing is allocated or copied.
+ *
+ * Big O-Notation: O(m)
+ */
+void visitElements(SET *sp, void (*visit)(), void *arg)
+{
+	assert(sp != NULL);
+	tableVisit(&sp->table, visit, arg);
+}
+
+/*
+ * Probe Lengths Function: Fills in hits and misses, each with n entries, with the distribution of probe lengths in sp. hits[i] is the number of elements whose successful search examines i + 1 slots, and misses[i] is the number of starting slots from which an unsuccessful search examines i + 1 slots, counted by walking backwards from an empty slot. Longer probes are counted in the last entry.
+ *
+ * Big O-Notation: O(m)
+ */
+void probeLengths(SET *sp, long hits[], long misses[], int n)
+{
+	assert(sp != NULL && n > 0);
+	struct table *tp = &sp->table;
+	int i, j, idx;
+	int run = 0;
+	for(i = 0; i < n; i++)
+	{
+		hits[i] = misses[i] = 0;
+	}
+	for(i = 0; i < tp->length; i++)
 	{
-		if(sp->flag[i] == 2)
+		if(tp->flags[i] == SET_FILLED)
 		{
-			data[j] = sp->data[i];
-			j++;
+			j = i - (int) (tp->hashes[i] % tp->length);
+			j = j < 0 ? j + tp->length : j;
+			hits[j < n ? j : n - 1]++;
 		}
 	}
-	return data;
+	for(idx = 0; idx < tp->length && tp->flags[idx] != SET_EMPTY; idx++)
+		;
+	if(idx == tp->length)
+	{
+		misses[n - 1] += tp->length;
+		return;
+	}
+	for(i = 0; i < tp->length; i++)
+	{
+		run = tp->flags[idx] == SET_EMPTY ? 0 : run + 1;
+		misses[run < n ? run : n - 1]++;
+		idx = idx > 0 ? idx - 1 : tp->length - 1;
+	}
 }
@@ -19,6 +19,7 @@
 # include <string.h>
 # include <stdbool.h>
 # include "set.h"
+# include "hash.h"
 
 
 /* This is sufficient for the test cases in /scratch/coen12. */
@@ -27,20 +28,14 @@
 
 
 /*
- * Function:    strhash
+ * Function:    printElement
  *
- * Description: Return a hash value for a string S.
+ * Description: Print the word ELT on a line of its own.
  */
 
-static unsigned strhash(char *s)
+static void printElement(char *elt, void *arg)
 {
-    unsigned hash = 0;
-
-
-    while (*s != '\0')
-        hash = 31 * hash + *s ++;
-
-    return hash;
+    printf("%s\n", elt);
 }
 
 
@@ -53,8 +48,9 @@ static unsigned strhash(char *s)
 int main(int argc, char *argv[])
 {
     FILE *fp;
-    char buffer[BUFSIZ], **elts, *word;
+    char buffer[BUFSIZ], *word;
     SET *unique;
+    HASHFN hash;
     int i, words;
     bool lflag = false;
 
@@ -79,11 +75,16 @@ int main(int argc, char *argv[])
         exit(EXIT_FAILURE);
     }
 
+    if ((hash = findHash(getenv("HASH"))) == NULL) {
+	fprintf(stderr, "%s: unknown hash %s\n", argv[0], getenv("HASH"));
+	exit(EXIT_FAILURE);
+    }
+
 
     /* Insert all words into the set. */
 
     words = 0;
-    unique = createSet(MAX_SIZE, strcmp, strhash);
+    unique = createSet(MAX_SIZE, strcmp, hash);
 
     while (fscanf(fp, "%s", buffer) == 1) {
         words ++;
@@ -127,12 +128,7 @@ int main(int argc, char *argv[])
     /* Print the list of words if desired. */
 
     if (lflag) {
-	elts = getElements(unique);
-
-	for (i = 0; i < numElements(unique); i ++)
-	    printf("%s\n", elts[i]);
-
-	free(elts);
+	visitElements(unique, printElement, NULL);
     }
 
     destroySet(unique);
@@ -13,73 +13,175 @@
 #include <stdbool.h>
 #include <assert.h>
 #include "set.h"
+#include "probe.h"
+#include "hash.h"
+#include "arena.h"
 
-#define FILLED 2
-#define DELETED 1
-#define EMPTY 0
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define EMPTY -128
+#define DELETED -2
+#define GROUP 16
+#define SHORT 14 //longest string kept inside its slot
+#define LONG 255 //length byte of a slot pointing to its string
+
+/*
+ * Each slot has a control byte in sp->ctrl.  An empty or deleted slot has a
+ * negative control byte, and a filled slot holds the top seven bits of its
+ * element's hash, so a search only calls strcmp when those bits match.  The
+ * first GROUP control bytes are repeated after the last one so that a
+ * group of GROUP bytes can be loaded starting at any slot.
+ *
+ * A string of at most SHORT characters is kept inside its slot along with its
+ * null terminator, and len is its length.  A longer string is copied with
+ * arenaDup, its pointer is kept in the slot, and len is LONG.  A slot is 16
+ * bytes, so a lookup of a short word only touches the slot's cache line.
+ */
+typedef struct slot{
+	union
+	{
+		char text[SHORT + 1];
+		char *ptr;
+	} u;
+	unsigned char len;
+
+} SLOT;
 
 typedef struct set{
 	int count;
 	int length;
-	char **data;
-	char *flag;
+	SLOT *data;
+	signed char *ctrl;
+	HASHFN hash; //chosen by the HASH environment variable
+	ARENA *arena; //holds the strings too long for their slots
 
 } SET;
 
-unsigned strhash(char *s)
+/*
+ * Mix Function: Scrambles the bits of a hash value so that both the low bits used for the slot and the top bits kept in the control byte depend on every character.
+ *
+ * Big O-Notation: O(1)
+ */
+static unsigned mix(unsigned hash)
+{
+	hash ^= hash >> 16;
+	hash *= 0x85ebca6b;
+	hash ^= hash >> 13;
+	hash *= 0xc2b2ae35;
+	hash ^= hash >> 16;
+	return hash;
+}
+
+/*
+ * Text Function: Returns the string held by the slot s.
+ *
+ * Big O-Notation: O(1)
+ */
+static char *text(SLOT *s)
+{
+	return s->len == LONG ? s->u.ptr : s->u.text;
+}
+
+/*
+ * Equal Function: Returns whether the slot s holds the string elt of length len.
+ *
+ * Big O-Notation: O(len)
+ */
+static bool equal(SLOT *s, char *elt, size_t len)
+{
+	if(len <= SHORT)
+	{
+		return s->len == len && memcmp(s->u.text, elt, len) == 0;
+	}
+	return s->len == LONG && strcmp(s->u.ptr, elt) == 0;
+}
+
+/*
+ * Match Function: Returns a bit mask with bit i set if the control byte ctrl[i] equals c, for each of the GROUP bytes starting at ctrl.
+ *
+ * Big O-Notation: O(1)
+ */
+static unsigned match(signed char *ctrl, signed char c)
 {
-	unsigned hash = 0;
-	while (*s != '\0')
+#ifdef __SSE2__
+	__m128i group = _mm_loadu_si128((__m128i *) ctrl);
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(c)));
+#else
+	unsigned mask = 0;
+	int i;
+	for(i = 0; i < GROUP; i++)
 	{
-		hash = 31 * hash + *s ++;
+		if(ctrl[i] == c)
+		{
+			mask |= 1u << i;
+		}
 	}
-	return hash;
+	return mask;
+#endif
 }
 
 /*
- * Search Function: Retrieves an element and searches for the element within sp->data. If element does not exist, functions returns index & false is found. Else, returns found == true and the index of element.
+ * Set Control Function: Sets the control byte for slot idx, along with its copy past the end if it has one.
+ *
+ * Big O-Notation: O(1)
+ */
+static void setCtrl(SET *sp, int idx, signed char c)
+{
+	sp->ctrl[idx] = c;
+	if(idx < GROUP)
+	{
+		sp->ctrl[sp->length + idx] = c;
+	}
+}
+
+/*
+ * Search Function: Searches for an element of length len with the given hash within sp->data, GROUP slots at a time. Only slots whose control byte matches the hash and that come before the first empty slot of the group are compared. If the element exists, returns found == true and its index. Else, returns found == false and the first deleted or empty slot seen, which is where the element belongs.
  *
  * Big O-Notation: O(m)
  */
-int search(SET *sp, char *elt, bool *found)
+static int search(SET *sp, char *elt, size_t len, unsigned hash, bool *found)
 {
 	assert(elt != NULL && sp != NULL && found != NULL);
-	int idx, start;
-	int b = 0;
-	int flag = 0;
-	idx = strhash(elt)%(sp->length);
-	start = idx;
-	idx++;
-	idx = idx % sp->length;
-	while(idx != start)
+	int idx, pos, n;
+	int b = -1;
+	unsigned matches, empties, vacant;
+	pos = hash % sp->length;
+	for(n = 0; n < sp->length; n += GROUP)
 	{
-		if(sp->flag[idx] == 0)
+		matches = match(sp->ctrl + pos, hash >> 25);
+		empties = match(sp->ctrl + pos, EMPTY);
+		if(empties != 0)
 		{
-			if(flag == 0)
-			{
-				*found = false;
-				return idx;
-			}
-			break;
+			matches &= (empties & -empties) - 1;
 		}
-		else if(sp->flag[idx] == 2)
+		while(matches != 0)
 		{
-			if(strcmp(elt, sp->data[idx]) == 0)
+			idx = pos + __builtin_ctz(matches);
+			idx = idx < sp->length ? idx : idx - sp->length;
+			if(equal(&sp->data[idx], elt, len))
 			{
 				*found = true;
 				return idx;
 			}
+			matches &= matches - 1;
 		}
-		else
+		if(b == -1)
 		{
-			if (flag == 0)
+			vacant = empties | match(sp->ctrl + pos, DELETED);
+			if(vacant != 0)
 			{
-				flag = 1;
-				b = idx;
+				b = pos + __builtin_ctz(vacant);
+				b = b < sp->length ? b : b - sp->length;
 			}
 		}
-		idx++;
-		idx = idx % sp->length;
+		if(empties != 0)
+		{
+			break;
+		}
+		pos += GROUP;
+		pos = pos < sp->length ? pos : pos - sp->length;
 	}
 	*found = false;
 	return b;
@@ -95,34 +197,31 @@ SET *createSet(int maxElts)
 	int i;
 	SET *sp = malloc(sizeof(SET));
 	assert(sp != NULL);
-	sp->length = maxElts;
+	sp->length = maxElts > GROUP ? maxElts : GROUP;
 	sp->count = 0;
-	sp->data = malloc(sizeof(char *)*maxElts);
-	sp->flag = malloc(sizeof(char )*maxElts);
-	for(i = 0; i < maxElts; i++)
+	sp->hash = findHash(getenv("HASH"));
+	assert(sp->hash != NULL);
+	sp->arena = createArena();
+	sp->data = malloc(sizeof(SLOT)*sp->length);
+	sp->ctrl = malloc(sizeof(signed char)*(sp->length + GROUP));
+	assert(sp->data != NULL && sp->ctrl != NULL);
+	for(i = 0; i < sp->length + GROUP; i++)
 	{
-		sp->flag[i] = 0;
+		sp->ctrl[i] = EMPTY;
 	}
 	return sp;
 }
 
 /*
- * Destroy Set Function: Free pointers in SET.
+ * Destroy Set Function: Free pointers in SET, releasing the long elements all at once with their arena.
  *
- * Big O-Notation: O(m)
+ * Big O-Notation: O(1)
  */
 void destroySet(SET *sp)
 {
 	assert(sp != NULL);
-	int i;
-	for(i = 0; i < sp->length; i++)
-	{
-		if(sp->flag[i] == 2)
-		{
-			free(sp->data[i]);
-		}
-	}
-	free(sp->flag);
+	destroyArena(sp->arena);
+	free(sp->ctrl);
 	free(sp->data);
 	free(sp);
 }
@@ -139,7 +238,7 @@ int numElements(SET *sp)
 }
 
 /*
- * Add Element Function: Add elements to sp->data if the element is not found.
+ * Add Element Function: Add elements to sp->data if the element is not found, copying short elements into the slot itself.
  *
  * Big O-Notation: O(m)
  */
@@ -149,11 +248,23 @@ void addElement(SET *sp, char *elt)
 	assert(elt != NULL);
 	bool found;
 	int idx;
-	idx = search(sp, elt, &found);
+	size_t len = strlen(elt);
+	unsigned hash = mix((*sp->hash)(elt));
+	idx = search(sp, elt, len, hash, &found);
 	if(found == false)
 	{
-		sp->data[idx] = strdup(elt);
-		sp->flag[idx] = 2;
+		assert(idx != -1);
+		if(len <= SHORT)
+		{
+			memcpy(sp->data[idx].u.text, elt, len + 1);
+			sp->data[idx].len = len;
+		}
+		else
+		{
+			sp->data[idx].u.ptr = arenaDup(sp->arena, elt);
+			sp->data[idx].len = LONG;
+		}
+		setCtrl(sp, idx, hash >> 25);
 		sp->count += 1;
 	}
 }
@@ -169,17 +280,20 @@ void removeElement(SET *sp, char *elt)
 	assert(elt != NULL);
 	bool found;
 	int idx;
-	idx = search(sp, elt, &found);
+	idx = search(sp, elt, strlen(elt), mix((*sp->hash)(elt)), &found);
 	if(found == true)
 	{
-		free(sp->data[idx]);
-		sp->flag[idx] = 1;
+		if(sp->data[idx].len == LONG)
+		{
+			arenaFree(sp->arena, sp->data[idx].u.ptr);
+		}
+		setCtrl(sp, idx, DELETED);
 		sp->count -= 1;
 	}
 }
 
 /*
- * Find Element Function: Takes elements and returns NULL if elements are not there & returns elements if it is there.
+ * Find Element Function: Takes elements and returns NULL if elements are not there & returns elements if it is there. A short element is returned from inside its slot, so it is only valid until it is removed.
  *
  * Big O-Notation: O(m)
  */
@@ -189,10 +303,10 @@ char *findElement(SET *sp, char *elt)
 	assert(elt != NULL);
 	bool found;
 	int idx;
-	idx = search(sp, elt, &found);
+	idx = search(sp, elt, strlen(elt), mix((*sp->hash)(elt)), &found);
 	if(found == false)
 		return NULL;
-	return sp->data[idx];
+	return text(&sp->data[idx]);
 }
 
 /*
@@ -208,11 +322,61 @@ char **getElements(SET *sp)
 	char **data = malloc(sizeof(char *)*(sp->count));
 	for(i = 0, j = 0; i < sp->length; i++)
 	{
-		if(sp->flag[i] == 2)
+		if(sp->ctrl[i] >= 0)
 		{
-			data[j] = sp->data[i];
+			data[j] = text(&sp->data[i]);
 			j++;
 		}
 	}
 	return data;
 }
+
+/*
+ * Visit Elements Function: Calls visit(elt, arg) on each element within sp->data in place, without allocating or copying. A short element is passed from inside its slot.
+ *
+ * Big O-Notation: O(m)
+ */
+void visitElements(SET *sp, void (*visit)(), void *arg)
+{
+	int i;
+	assert(sp != NULL);
+	assert(visit != NULL);
+	for(i = 0; i < sp->length; i++)
+	{
+		if(sp->ctrl[i] >= 0)
+		{
+			(*visit)(text(&sp->data[i]), arg);
+		}
+	}
+}
+
+/*
+ * Probe Lengths Function: Fills in hits and misses, each with n entries, with the distribution of probe lengths in sp, measured in groups of GROUP slots since that is how a search examines them. hits[i] is the number of elements whose successful search loads i + 1 groups, and misses[i] is the number of starting slots from which an unsuccessful search loads i + 1 groups before it finds one with an empty slot. Longer probes are counted in the last entry.
+ *
+ * Big O-Notation: O(m)
+ */
+void probeLengths(SET *sp, long hits[], long misses[], int n)
+{
+	assert(sp != NULL && n > 0);
+	int i, j, pos;
+	for(i = 0; i < n; i++)
+	{
+		hits[i] = misses[i] = 0;
+	}
+	for(i = 0; i < sp->length; i++)
+	{
+		if(sp->ctrl[i] >= 0)
+		{
+			j = i - (int) (mix((*sp->hash)(text(&sp->data[i]))) % sp->length);
+			j = (j < 0 ? j + sp->length : j) / GROUP;
+			hits[j < n ? j : n - 1]++;
+		}
+		pos = i;
+		for(j = 0; j < n - 1 && match(sp->ctrl + pos, EMPTY) == 0; j++)
+		{
+			pos += GROUP;
+			pos = pos < sp->length ? pos : pos - sp->length;
+		}
+		misses[j]++;
+	}
+}
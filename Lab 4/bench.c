@@ -0,0 +1,327 @@
+/*
+ * File:        bench.c
+ *
+ * Description: This file contains the main function for measuring the
+ *              cost of allocating list nodes.
+ *
+ *              The program takes a single file as a command line argument
+ *              and reads all of its words into memory.  It then times two
+ *              workloads that spend most of their time adding nodes to
+ *              lists and removing them: a radix sort of random numbers, as
+ *              in radix.c, and the parity workload on the chained set in
+ *              set.c, which also creates one list per bucket.  The radix
+ *              sort is timed twice, once gathering the buckets back into
+ *              the list one item at a time and once appending each bucket
+ *              whole with appendList.  The number of numbers to sort is
+ *              given with -n and defaults to NUMBERS.  A third workload
+ *              keeps the most recently used CACHE words in a list, moving
+ *              each word to the front when it is used again, and is timed
+ *              with a plain list and with an indexed one.  Last, every
+ *              word is looked up in a set holding all of them, one at a
+ *              time with findElement and BATCH at a time with
+ *              findElements.  The make
+ *              file builds this program twice, as bench with the node
+ *              pool in list.c and as bench_nopool with every node taken
+ *              from malloc, so running both compares the two.
+ */
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <stdbool.h>
+# include <unistd.h>
+# include <time.h>
+# include <assert.h>
+# include "list.h"
+# include "set.h"
+# include "hash.h"
+
+# define NUMBERS 100000
+# define RADIX 10
+# define ROUNDS 5
+# define CACHE 1000
+# define BATCH 64
+
+
+/*
+ * Function:    seconds
+ *
+ * Description: Return the current value of a monotonic clock in seconds.
+ */
+
+static double seconds(void)
+{
+    struct timespec ts;
+
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+/*
+ * Function:    radixSort
+ *
+ * Description: Sort the N numbers in VALUES with a radix sort using
+ *		lists, as radix.c does, and check the result.  If SPLICE is
+ *		true, each bucket is appended to the list whole after each
+ *		pass, and otherwise its items are moved one at a time.
+ */
+
+static void radixSort(int *values, int n, bool splice)
+{
+    LIST *a, *lists[RADIX];
+    int i, div, max, *p, last;
+
+
+    a = createList(NULL);
+
+    for (i = 0; i < RADIX; i ++)
+	lists[i] = createList(NULL);
+
+    for (i = max = 0; i < n; i ++) {
+	addLast(a, &values[i]);
+	max = values[i] > max ? values[i] : max;
+    }
+
+    for (div = 1; max / div > 0; div *= RADIX) {
+	while (numItems(a) > 0) {
+	    p = removeFirst(a);
+	    addLast(lists[*p / div % RADIX], p);
+	}
+
+	for (i = 0; i < RADIX; i ++)
+	    if (splice)
+		appendList(a, lists[i]);
+	    else
+		while (numItems(lists[i]) > 0)
+		    addLast(a, removeFirst(lists[i]));
+    }
+
+    for (last = 0; numItems(a) > 0; last = *p) {
+	p = removeFirst(a);
+	assert(*p >= last);
+    }
+
+    for (i = 0; i < RADIX; i ++)
+	destroyList(lists[i]);
+
+    destroyList(a);
+}
+
+
+/*
+ * Function:    parity
+ *
+ * Description: Run the parity workload on the N words in WORDS with a
+ *		chained set and return the number of words that occur an
+ *		odd number of times.
+ */
+
+static int parity(char **words, int n)
+{
+    SET *odd;
+    int i, count;
+
+
+    odd = createSet(n, strcmp, strhash);
+
+    for (i = 0; i < n; i ++)
+	if (findElement(odd, words[i]) != NULL)
+	    removeElement(odd, words[i]);
+	else
+	    addElement(odd, words[i]);
+
+    count = numElements(odd);
+    destroySet(odd);
+    return count;
+}
+
+
+/*
+ * Function:    recent
+ *
+ * Description: Keep the CACHE most recently used of the N words in WORDS
+ *		in a list, most recent first, and return the number of
+ *		words found in it.  If INDEXED is true, the list is created
+ *		with a hash index.
+ */
+
+static int recent(char **words, int n, bool indexed)
+{
+    LIST *lp;
+    int i, hits;
+
+
+    lp = indexed ? createIndexedList(strcmp, strhash) : createList(strcmp);
+
+    for (i = hits = 0; i < n; i ++) {
+	if (findItem(lp, words[i]) != NULL) {
+	    removeItem(lp, words[i]);
+	    hits ++;
+	} else if (numItems(lp) == CACHE)
+	    removeLast(lp);
+
+	addFirst(lp, words[i]);
+    }
+
+    destroyList(lp);
+    return hits;
+}
+
+
+/*
+ * Function:    lookup
+ *
+ * Description: Look up each of the N words in WORDS in the set pointed to
+ *		by SP and return the number found.  If BATCHED is true, the
+ *		words are looked up BATCH at a time with findElements.
+ */
+
+static int lookup(SET *sp, char **words, int n, bool batched)
+{
+    void *found[BATCH];
+    int i, j, m, hits;
+
+
+    for (i = hits = 0; i < n; i += m) {
+	m = n - i < BATCH ? n - i : BATCH;
+
+	if (batched)
+	    findElements(sp, (void **) words + i, found, m);
+	else
+	    for (j = 0; j < m; j ++)
+		found[j] = findElement(sp, words[i + j]);
+
+	for (j = 0; j < m; j ++)
+	    hits += found[j] != NULL;
+    }
+
+    return hits;
+}
+
+
+/*
+ * Function:    main
+ *
+ * Description: Driver function for the benchmark.
+ */
+
+int main(int argc, char *argv[])
+{
+    FILE *fp;
+    char buffer[BUFSIZ], **words;
+    double start, best;
+    SET *all;
+    int i, c, n, size, round, which, numbers, *values;
+
+
+    /* Check usage and open the file. */
+
+    numbers = NUMBERS;
+
+    while ((c = getopt(argc, argv, "n:")) != -1)
+	numbers = c == 'n' ? atoi(optarg) : 0;
+
+    if (numbers < 1 || argc - optind != 1) {
+        fprintf(stderr, "usage: %s [-n numbers] file\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    if ((fp = fopen(argv[optind], "r")) == NULL) {
+        fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[optind]);
+        exit(EXIT_FAILURE);
+    }
+
+
+    /* Read all of the words into memory. */
+
+    n = 0;
+    size = 1024;
+    words = malloc(sizeof(char *) * size);
+    assert(words != NULL);
+
+    while (fscanf(fp, "%s", buffer) == 1) {
+	if (n == size) {
+	    size *= 2;
+	    words = realloc(words, sizeof(char *) * size);
+	    assert(words != NULL);
+	}
+
+	words[n] = strdup(buffer);
+	assert(words[n] != NULL);
+	n ++;
+    }
+
+    fclose(fp);
+
+
+    /* Time each workload, keeping the best of several rounds. */
+
+    values = malloc(sizeof(int) * numbers);
+    assert(values != NULL);
+    srand(1);
+
+    for (i = 0; i < numbers; i ++)
+	values[i] = rand() % 1000000000;
+
+    for (which = 0; which <= 1; which ++) {
+	for (round = 0, best = 0; round < ROUNDS; round ++) {
+	    start = seconds();
+	    radixSort(values, numbers, which);
+	    start = seconds() - start;
+	    best = round == 0 || start < best ? start : best;
+	}
+
+	printf("radix   %d numbers %10.4f seconds (%s)\n", numbers, best,
+	    which ? "append" : "move");
+    }
+
+    for (round = 0, best = 0; round < ROUNDS; round ++) {
+	start = seconds();
+	size = parity(words, n);
+	start = seconds() - start;
+	best = round == 0 || start < best ? start : best;
+    }
+
+    printf("parity  %d words   %10.4f seconds (%d odd)\n", n, best, size);
+
+    for (which = 0; which <= 1; which ++) {
+	for (round = 0, best = 0; round < ROUNDS; round ++) {
+	    start = seconds();
+	    size = recent(words, n, which);
+	    start = seconds() - start;
+	    best = round == 0 || start < best ? start : best;
+	}
+
+	printf("recent  %d words   %10.4f seconds (%d hits, %s)\n", n, best,
+	    size, which ? "indexed" : "plain");
+    }
+
+    all = createSet(n, strcmp, strhash);
+
+    for (i = 0; i < n; i ++)
+	if (findElement(all, words[i]) == NULL)
+	    addElement(all, words[i]);
+
+    for (which = 0; which <= 1; which ++) {
+	for (round = 0, best = 0; round < ROUNDS; round ++) {
+	    start = seconds();
+	    size = lookup(all, words, n, which);
+	    start = seconds() - start;
+	    best = round == 0 || start < best ? start : best;
+	}
+
+	printf("lookup  %d words   %10.4f seconds (%d found, %s)\n", n, best,
+	    size, which ? "batched" : "single");
+    }
+
+    destroySet(all);
+
+    for (i = 0; i < n; i ++)
+	free(words[i]);
+
+    free(words);
+    free(values);
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,385 @@
+/*
+ * File: bucket.c
+ *
+ * Description: Contains a chained implementation of the set in set.h, which can be used in place of set.c by building with "make SET=bucket.o". Instead of a list per bucket, each bucket is a block of one cache line holding up to SLOTS elements beside their hash values, with further blocks chained on only when it overflows. A search compares the cached hash values first and calls compare only when one matches, so a miss usually reads a single cache line, and adding or removing an element takes one pass over its chain. The table starts with one bucket for every LOAD elements the set is created to hold, and grows by linear hashing, splitting one bucket each time an add takes the mean chain past MAX_LOAD elements. The buckets are kept in segments of SEGMENT buckets that never move, so growing the table only ever copies the directory of segments.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <assert.h>
+#include "set.h"
+#include "probe.h"
+
+#define SLOTS 4
+#define LOAD 3
+#ifndef MAX_LOAD
+#define MAX_LOAD LOAD
+#endif
+#define SEGMENT 256 //buckets per segment, a power of two
+#define BATCH 64 //elements findElements hashes before searching
+
+typedef struct block
+{
+	unsigned hashes[SLOTS];
+	void *elts[SLOTS];
+	struct block *next; //overflow block, or NULL
+	int count;
+}BLOCK;
+
+typedef struct set
+{
+	int count;
+	int length;
+	int segments; //segments allocated in the directory
+	int limit; //buckets at the start of this round of splits
+	int split; //next bucket to split
+	BLOCK **dir;
+	int(*compare)();
+	unsigned (*hash)();
+}SET;
+
+/*
+ * New Block Function: Allocates an empty block on a cache line of its own.
+ *
+ * Big-O Notation: O(1)
+ */
+static BLOCK *newBlock(void)
+{
+	BLOCK *bp = aligned_alloc(64, sizeof(BLOCK));
+	assert(bp != NULL);
+	bp->next = NULL;
+	bp->count = 0;
+	return bp;
+}
+
+/*
+ * Bucket Function: Returns the ith bucket of the table.
+ *
+ * Big-O Notation: O(1)
+ */
+static BLOCK *bucket(SET *sp, int i)
+{
+	return &sp->dir[i / SEGMENT][i % SEGMENT];
+}
+
+/*
+ * Locate Function: Returns the bucket for hash value h. Buckets before split have already been split this round, so their elements are spread over twice as many buckets.
+ *
+ * Big-O Notation: O(1)
+ */
+static BLOCK *locate(SET *sp, unsigned h)
+{
+	int i = h % sp->limit;
+	if(i < sp->split)
+		i = h % (2*sp->limit);
+	return bucket(sp, i);
+}
+
+/*
+ * Append Function: Adds elt, whose hash value is h, after the last element of the chain whose last block is *tail, chaining on a new block and updating *tail if that one is full.
+ *
+ * Big-O Notation: O(1)
+ */
+static void append(BLOCK **tail, void *elt, unsigned h)
+{
+	BLOCK *bp = *tail;
+	if(bp->count == SLOTS)
+	{
+		bp->next = newBlock();
+		bp = *tail = bp->next;
+	}
+	bp->hashes[bp->count] = h;
+	bp->elts[bp->count] = elt;
+	bp->count++;
+}
+
+/*
+ * Split Bucket Function: Splits the next bucket in turn, as in linear hashing, moving the elements that now belong in the new last bucket into it. Only one chain is rehashed at a time, using the cached hash values, and a segment is added when the new bucket needs one.
+ *
+ * Big-O Notation: O(1) amortized
+ */
+static void splitBucket(SET *sp)
+{
+	BLOCK *old, *keep, *move, *bp, *pNext, chain;
+	int i;
+	if(sp->length % SEGMENT == 0)
+	{
+		if(sp->length / SEGMENT == sp->segments)
+		{
+			sp->segments *= 2;
+			sp->dir = realloc(sp->dir, sizeof(BLOCK *)*sp->segments);
+			assert(sp->dir != NULL);
+		}
+		sp->dir[sp->length / SEGMENT] = aligned_alloc(64, sizeof(BLOCK)*SEGMENT);
+		assert(sp->dir[sp->length / SEGMENT] != NULL);
+	}
+	old = keep = bucket(sp, sp->split);
+	move = bucket(sp, sp->length);
+	move->next = NULL;
+	move->count = 0;
+
+	chain = *old;
+	old->next = NULL;
+	old->count = 0;
+	for(bp = &chain; bp != NULL; bp = pNext)
+	{
+		for(i = 0; i < bp->count; i++)
+		{
+			if(bp->hashes[i] % (2*sp->limit) == sp->split)
+				append(&keep, bp->elts[i], bp->hashes[i]);
+			else
+				append(&move, bp->elts[i], bp->hashes[i]);
+		}
+		pNext = bp->next;
+		if(bp != &chain)
+			free(bp);
+	}
+
+	sp->length++;
+	if(++sp->split == sp->limit)
+	{
+		sp->split = 0;
+		sp->limit *= 2;
+	}
+}
+
+/*
+ * Search Function: Returns the element of the chain at bp equal to elt, whose hash value is h, and sets *where and *slot to its block and slot. If there is none, it returns NULL and sets *where to the last block of the chain.
+ *
+ * Big-O Notation: O(n)
+ */
+static void *search(SET *sp, BLOCK *bp, void *elt, unsigned h, BLOCK **where, int *slot)
+{
+	int i;
+	for(;;)
+	{
+		for(i = 0; i < bp->count; i++)
+		{
+			if(bp->hashes[i] == h && (*sp->compare)(bp->elts[i], elt) == 0)
+			{
+				*where = bp;
+				*slot = i;
+				return bp->elts[i];
+			}
+		}
+		if(bp->next == NULL)
+			break;
+		bp = bp->next;
+	}
+	*where = bp;
+	return NULL;
+}
+
+/*
+ * Create Set Function: Creates a set with one bucket for every LOAD of the maxElts elements and the given compare and hash functions. More buckets are added as elements are.
+ *
+ * Big-O Notation: O(m)
+ */
+SET *createSet(int maxElts, int (*compare)(), unsigned (*hash)())
+{
+	SET *sp = malloc(sizeof(SET));
+	assert(sp != NULL);
+	sp->compare = compare;
+	sp->hash = hash;
+	sp->count = 0;
+	sp->length = maxElts / LOAD > 0 ? maxElts / LOAD : 1;
+	sp->limit = sp->length;
+	sp->split = 0;
+	sp->segments = (sp->length + SEGMENT - 1) / SEGMENT;
+	sp->dir = malloc(sizeof(BLOCK *)*sp->segments);
+	assert(sp->dir != NULL);
+	int i;
+	for(i = 0; i < sp->segments; i++)
+	{
+		sp->dir[i] = aligned_alloc(64, sizeof(BLOCK)*SEGMENT);
+		assert(sp->dir[i] != NULL);
+		memset(sp->dir[i], 0, sizeof(BLOCK)*SEGMENT);
+	}
+	return sp;
+}
+
+/*
+ * Destroy Set Function: Destroys the SET sp, its buckets, and their overflow blocks.
+ *
+ * Big-O Notation: O(m)
+ */
+void destroySet(SET *sp)
+{
+	assert(sp != NULL);
+	BLOCK *bp, *pNext;
+	int i;
+	for(i = 0; i < sp->length; i++)
+	{
+		for(bp = bucket(sp, i)->next; bp != NULL; bp = pNext)
+		{
+			pNext = bp->next;
+			free(bp);
+		}
+	}
+	for(i = 0; i * SEGMENT < sp->length; i++)
+		free(sp->dir[i]);
+	free(sp->dir);
+	free(sp);
+}
+
+/*
+ * Num Elements Function: Returns the number of elements in the set.
+ *
+ * Big-O Notation: O(1)
+ */
+int numElements(SET *sp)
+{
+	assert(sp != NULL);
+	return sp->count;
+}
+
+/*
+ * Add Element Function: Adds an element to SET sp in the last block of its chain, chaining on a new block if that one is full, and splits a bucket if the mean chain length is then past MAX_LOAD.
+ *
+ * Big-O Notation: O(1) average
+ */
+void addElement(SET *sp, void *elt)
+{
+	assert(sp != NULL && elt != NULL);
+	unsigned h = (*sp->hash)(elt);
+	BLOCK *bp;
+	int i;
+	if(search(sp, locate(sp, h), elt, h, &bp, &i) != NULL)
+		return;
+	append(&bp, elt, h);
+	sp->count++;
+	if(sp->count > MAX_LOAD*sp->length)
+		splitBucket(sp);
+}
+
+/*
+ * Remove Element Function: Removes an element from the SET sp, filling its slot with the last element of its chain and freeing the last block if that leaves it empty.
+ *
+ * Big-O Notation: O(1) average
+ */
+void removeElement(SET *sp, void *elt)
+{
+	assert(sp != NULL && elt != NULL);
+	unsigned h = (*sp->hash)(elt);
+	BLOCK *head = locate(sp, h);
+	BLOCK *bp, *last, *prev = NULL;
+	int i;
+	if(search(sp, head, elt, h, &bp, &i) == NULL)
+		return;
+	for(last = bp; last->next != NULL; last = last->next)
+		prev = last;
+	last->count--;
+	bp->hashes[i] = last->hashes[last->count];
+	bp->elts[i] = last->elts[last->count];
+	if(last->count == 0 && last != head)
+	{
+		if(prev == NULL)
+			for(prev = head; prev->next != last; prev = prev->next);
+		prev->next = NULL;
+		free(last);
+	}
+	sp->count--;
+}
+
+/*
+ * Find Element Function: Returns the element of SET sp equal to elt, or NULL if there is none.
+ *
+ * Big-O Notation: O(1) average
+ */
+void *findElement(SET *sp, void *elt)
+{
+	assert(sp != NULL && elt != NULL);
+	unsigned h = (*sp->hash)(elt);
+	BLOCK *bp;
+	int i;
+	return search(sp, locate(sp, h), elt, h, &bp, &i);
+}
+
+/*
+ * Find Elements Function: Sets found[i] to the element of SET sp equal to elts[i], or NULL, for each of the n elements. The elements and then their buckets are prefetched BATCH at a time before any is searched, so that the misses on them overlap. Chains are short enough here that walking them one at a time costs little more.
+ *
+ * Big-O Notation: O(1) average per element
+ */
+void findElements(SET *sp, void *elts[], void *found[], int n)
+{
+	assert(sp != NULL && n >= 0);
+	BLOCK *heads[BATCH], *bp;
+	unsigned hashes[BATCH];
+	int i, j, k, m;
+	for(i = 0; i < n; i += m)
+	{
+		m = n - i < BATCH ? n - i : BATCH;
+		for(j = 0; j < m; j++)
+			__builtin_prefetch(elts[i + j]);
+		for(j = 0; j < m; j++)
+		{
+			hashes[j] = (*sp->hash)(elts[i + j]);
+			heads[j] = locate(sp, hashes[j]);
+			__builtin_prefetch(heads[j]);
+		}
+		for(j = 0; j < m; j++)
+			found[i + j] = search(sp, heads[j], elts[i + j], hashes[j], &bp, &k);
+	}
+}
+
+/*
+ * Get Elements Function: Returns array of the data of SET sp.
+ *
+ * Big-O Notation: O(m)
+ */
+void *getElements(SET *sp)
+{
+	assert(sp != NULL);
+	void **data = malloc(sizeof(void *)*(sp->count > 0 ? sp->count : 1));
+	assert(data != NULL);
+	BLOCK *bp;
+	int i, k = 0;
+	for(i = 0; i < sp->length; i++)
+	{
+		for(bp = bucket(sp, i); bp != NULL; bp = bp->next)
+		{
+			memcpy(data + k, bp->elts, sizeof(void *)*bp->count);
+			k += bp->count;
+		}
+	}
+	return data;
+}
+
+/*
+ * Visit Elements Function: Calls visit(elt, arg) on each element of SET sp, walking each chain in place.
+ *
+ * Big-O Notation: O(m)
+ */
+void visitElements(SET *sp, void (*visit)(), void *arg)
+{
+	assert(sp != NULL && visit != NULL);
+	BLOCK *bp;
+	int i, j;
+	for(i = 0; i < sp->length; i++)
+		for(bp = bucket(sp, i); bp != NULL; bp = bp->next)
+			for(j = 0; j < bp->count; j++)
+				(*visit)(bp->elts[j], arg);
+}
+
+/*
+ * Probe Lengths Function: Fills in hits and misses, each with n entries, with the distribution of chain lengths in sp, as in set.c. hits[i] is the number of elements that are found at the ith slot of their chain, and misses[i] is the number of buckets whose chains hold i elements. Longer chains are counted in the last entry.
+ *
+ * Big-O Notation: O(m)
+ */
+void probeLengths(SET *sp, long hits[], long misses[], int n)
+{
+	assert(sp != NULL && n > 0);
+	BLOCK *bp;
+	int i, j, k;
+	for(i = 0; i < n; i++)
+		hits[i] = misses[i] = 0;
+	for(i = 0; i < sp->length; i++)
+	{
+		for(k = 0, bp = bucket(sp, i); bp != NULL; bp = bp->next)
+			k += bp->count;
+		misses[k < n ? k : n - 1]++;
+		for(j = 1; j <= k; j++)
+			hits[j < n ? j : n - 1]++;
+	}
+}
@@ -0,0 +1,171 @@
+/*
+ * File: index.c
+ *
+ * Description: Contains the hash index in index.h, which list.c and ulist.c keep beside an indexed list so that findItem and removeItem need not scan it. Entries are kept in a table of a power of two slots with linear probing, each holding the item, where the list holds it, and the item's hash value. A removed entry is marked deleted, and the table is rebuilt, larger if need be, once its filled and deleted slots together pass three quarters of it.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <assert.h>
+#include "index.h"
+
+#define MIN_LENGTH 16
+
+typedef struct entry
+{
+	void *item;
+	void *where; //NULL if the slot is empty
+	unsigned hash;
+}ENTRY;
+
+typedef struct index
+{
+	int count; //filled slots
+	int used; //filled and deleted slots
+	int length;
+	ENTRY *entries;
+	int(*compare)();
+	unsigned (*hash)();
+}INDEX;
+
+static char deleted; //where of a deleted entry
+
+/*
+ * Create Index Function: Initializes an empty index for items with the given compare and hash functions.
+ *
+ * Big-O Notation: O(1)
+ */
+INDEX *createIndex(int (*compare)(), unsigned (*hash)())
+{
+	assert(compare != NULL && hash != NULL);
+	INDEX *ip = malloc(sizeof(INDEX));
+	assert(ip != NULL);
+	ip->compare = compare;
+	ip->hash = hash;
+	ip->count = ip->used = 0;
+	ip->length = MIN_LENGTH;
+	ip->entries = calloc(ip->length, sizeof(ENTRY));
+	assert(ip->entries != NULL);
+	return ip;
+}
+
+/*
+ * Destroy Index Function: Frees the index and its table.
+ *
+ * Big-O Notation: O(1)
+ */
+void destroyIndex(INDEX *ip)
+{
+	assert(ip != NULL);
+	free(ip->entries);
+	free(ip);
+}
+
+/*
+ * Clear Index Function: Removes every entry from the index, keeping its table.
+ *
+ * Big-O Notation: O(m)
+ */
+void clearIndex(INDEX *ip)
+{
+	assert(ip != NULL);
+	memset(ip->entries, 0, sizeof(ENTRY)*ip->length);
+	ip->count = ip->used = 0;
+}
+
+/*
+ * Rebuild Function: Moves the entries to a table of two to four slots per entry, dropping the deleted ones.
+ *
+ * Big-O Notation: O(m)
+ */
+static void rebuild(INDEX *ip)
+{
+	ENTRY *old = ip->entries;
+	int oldLength = ip->length;
+	int i, j;
+
+	while(ip->length > MIN_LENGTH && (ip->count + 1)*4 < ip->length)
+		ip->length /= 2;
+	while((ip->count + 1)*2 > ip->length)
+		ip->length *= 2;
+	ip->entries = calloc(ip->length, sizeof(ENTRY));
+	assert(ip->entries != NULL);
+	ip->used = ip->count;
+
+	for(i = 0; i < oldLength; i++)
+	{
+		if(old[i].where != NULL && old[i].where != &deleted)
+		{
+			j = old[i].hash & (ip->length - 1);
+			while(ip->entries[j].where != NULL)
+				j = (j + 1) & (ip->length - 1);
+			ip->entries[j] = old[i];
+		}
+	}
+	free(old);
+}
+
+/*
+ * Add Entry Function: Records that item is held at where, alongside any entries for equal items.
+ *
+ * Big-O Notation: O(1) average
+ */
+void addEntry(INDEX *ip, void *item, void *where)
+{
+	assert(ip != NULL && where != NULL);
+	if((ip->used + 1)*4 > ip->length*3)
+		rebuild(ip);
+	unsigned h = (*ip->hash)(item);
+	int i = h & (ip->length - 1);
+	while(ip->entries[i].where != NULL && ip->entries[i].where != &deleted)
+		i = (i + 1) & (ip->length - 1);
+	if(ip->entries[i].where == NULL)
+		ip->used++;
+	ip->entries[i].item = item;
+	ip->entries[i].where = where;
+	ip->entries[i].hash = h;
+	ip->count++;
+}
+
+/*
+ * Remove Entry Function: Removes the entry recording that item is held at where, which must be in the index.
+ *
+ * Big-O Notation: O(1) average
+ */
+void removeEntry(INDEX *ip, void *item, void *where)
+{
+	assert(ip != NULL && where != NULL);
+	unsigned h = (*ip->hash)(item);
+	int i = h & (ip->length - 1);
+	while(ip->entries[i].where != NULL)
+	{
+		if(ip->entries[i].where == where && ip->entries[i].hash == h && (*ip->compare)(ip->entries[i].item, item) == 0)
+		{
+			ip->entries[i].where = &deleted;
+			ip->count--;
+			return;
+		}
+		i = (i + 1) & (ip->length - 1);
+	}
+	assert(false);
+}
+
+/*
+ * Find Entry Function: Returns where an item equal to item is held, or NULL if there is none.
+ *
+ * Big-O Notation: O(1) average
+ */
+void *findEntry(INDEX *ip, void *item)
+{
+	assert(ip != NULL);
+	unsigned h = (*ip->hash)(item);
+	int i = h & (ip->length - 1);
+	while(ip->entries[i].where != NULL)
+	{
+		if(ip->entries[i].where != &deleted && ip->entries[i].hash == h && (*ip->compare)(ip->entries[i].item, item) == 0)
+			return ip->entries[i].where;
+		i = (i + 1) & (ip->length - 1);
+	}
+	return NULL;
+}
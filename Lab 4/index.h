@@ -0,0 +1,29 @@
+/*
+ * File:        index.h
+ *
+ * Description: This file contains the public function and type
+ *              declarations for the hash index kept by an indexed list.
+ *              An index maps each item of a list to where the list holds
+ *              it, which is a node in list.c and a block in ulist.c.  An
+ *              item may have several entries if equal items are added, and
+ *              findEntry then returns where any one of them is held.
+ */
+
+# ifndef INDEX_H
+# define INDEX_H
+
+typedef struct index INDEX;
+
+extern INDEX *createIndex(int (*compare)(), unsigned (*hash)());
+
+extern void destroyIndex(INDEX *ip);
+
+extern void clearIndex(INDEX *ip);
+
+extern void addEntry(INDEX *ip, void *item, void *where);
+
+extern void removeEntry(INDEX *ip, void *item, void *where);
+
+extern void *findEntry(INDEX *ip, void *item);
+
+# endif /* INDEX_H */
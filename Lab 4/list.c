@@ -13,6 +13,7 @@
 #include <stdbool.h>
 #include <assert.h>
 #include "list.h"
+#include "index.h"
 
 typedef struct node
 {
@@ -25,9 +26,62 @@ typedef struct list
 {
 	int count;
 	struct node *head;
+	struct node sentinel;
 	int(*compare)();
+	INDEX *index; //maps items to their nodes, or NULL if not indexed
 }LIST;
 
+#define GROUP 16 //searches findItems keeps in flight
+
+#ifndef NOPOOL
+#define SLAB_NODES 1024
+
+static __thread NODE *freeNodes;
+#endif
+
+/*
+ * Alloc Node Function: Returns a node from this thread's pool of free nodes, first carving a slab of SLAB_NODES nodes into it if it is empty. Nodes are never given back to malloc, so once the pool holds as many nodes as a thread has used at once, adding to a list costs no malloc at all. With -DNOPOOL every node comes from malloc instead.
+ *
+ * Big-O Notation: O(1) amortized
+ */
+static NODE *allocNode(void)
+{
+	NODE *np;
+#ifdef NOPOOL
+	np = malloc(sizeof(NODE));
+	assert(np != NULL);
+#else
+	int i;
+	if(freeNodes == NULL)
+	{
+		np = malloc(sizeof(NODE)*SLAB_NODES);
+		assert(np != NULL);
+		for(i = 0; i < SLAB_NODES - 1; i++)
+			np[i].next = &np[i+1];
+		np[SLAB_NODES - 1].next = NULL;
+		freeNodes = np;
+	}
+	np = freeNodes;
+	freeNodes = np->next;
+#endif
+	return np;
+}
+
+/*
+ * Free Node Function: Returns a node to this thread's pool of free nodes, which may be used by any list.
+ *
+ * Big-O Notation: O(1)
+ */
+static void freeNode(NODE *np)
+{
+#ifdef NOPOOL
+	free(np);
+#else
+	np->next = freeNodes;
+	freeNodes = np;
+#endif
+}
+
 /*
  * Create List Function: Initializes the list.
  *
@@ -37,11 +91,24 @@ LIST *createList(int (*compare)())
 {
 	LIST *lp = malloc(sizeof(LIST));
 	assert(lp != NULL);
-	lp->head = malloc(sizeof(NODE));
+	lp->head = &lp->sentinel;
 	lp->compare = compare;
 	lp->count = 0;
 	lp->head->next = lp->head;
 	lp->head->prev = lp->head;
+	lp->index = NULL;
+	return lp;
+}
+
+/*
+ * Create Indexed List Function: Initializes a list that also keeps a hash index from its items to their nodes, so that findItem and removeItem need not traverse it. Every add and remove then hashes the item as well.
+ *
+ * Big-O Notation: O(1)
+ */
+LIST *createIndexedList(int (*compare)(), unsigned (*hash)())
+{
+	LIST *lp = createList(compare);
+	lp->index = createIndex(compare, hash);
 	return lp;
 }
 
@@ -54,14 +121,17 @@ void destroyList(LIST *lp)
 {
 	assert(lp != NULL);
 	NODE *pDelete, *pNext;
-	pDelete = lp->head;
+	pDelete = lp->head->next;
 
-	do{
+	while(pDelete != lp->head)
+	{
 		pNext = pDelete->next;
-		free(pDelete);
+		freeNode(pDelete);
 		pDelete = pNext;
-	}while(pDelete != lp->head);
+	}
 	
+	if(lp->index != NULL)
+		destroyIndex(lp->index);
 	free(lp);
 }
 
@@ -84,8 +154,7 @@ int numItems(LIST *lp)
 void addFirst(LIST *lp, void *item)
 {
 	assert(lp != NULL);
-	NODE *temp = malloc(sizeof(NODE));
-	assert(temp != NULL);
+	NODE *temp = allocNode();
 	temp->data = item;
 
 	lp->head->next->prev = temp;
@@ -93,6 +162,8 @@ void addFirst(LIST *lp, void *item)
 	temp->prev = lp->head;
 	lp->head->next = temp;
 
+	if(lp->index != NULL)
+		addEntry(lp->index, item, temp);
 	lp->count++;
 	return;
 }
@@ -105,7 +176,7 @@ void addFirst(LIST *lp, void *item)
 void addLast(LIST *lp, void *item)
 {
 	assert(lp != NULL && item != NULL);
-	NODE *temp = malloc(sizeof(NODE));
+	NODE *temp = allocNode();
 	temp->data = item;
 
 	lp->head->prev->next = temp;
@@ -113,6 +184,8 @@ void addLast(LIST *lp, void *item)
 	temp->prev = lp->head->prev;
 	lp->head->prev = temp;
 
+	if(lp->index != NULL)
+		addEntry(lp->index, item, temp);
 	lp->count++;
 	return;
 }
@@ -130,8 +203,10 @@ void *removeFirst(LIST *lp)
 	item = pDelete->data;
 	lp->head->next = pDelete->next;
 	pDelete->next->prev = lp->head;
+	if(lp->index != NULL)
+		removeEntry(lp->index, item, pDelete);
 	lp->count--;
-	free(pDelete);
+	freeNode(pDelete);
 	return item;
 }
 
@@ -150,8 +225,10 @@ void *removeLast(LIST *lp)
 	lp->head->prev = pDelete->prev;
 	pDelete->prev->next = lp->head;
 
+	if(lp->index != NULL)
+		removeEntry(lp->index, item, pDelete);
 	lp->count--;
-	free(pDelete);
+	freeNode(pDelete);
 	return item;
 }
 
@@ -178,22 +255,35 @@ void *getLast(LIST *lp)
 }
 
 /*
- * Remove Item Function: Removes an item from list.
+ * Remove Item Function: Removes an item from list. An indexed list finds the node through its index instead of traversing the list.
  *
- * Big-O Notation: O(n)
+ * Big-O Notation: O(n), O(1) average if indexed
  */
 void removeItem(LIST *lp, void *item)
 {
 	assert(lp != NULL);
 	NODE *pSearch = lp->head->next;
 	int i;
+	if(lp->index != NULL)
+	{
+		pSearch = findEntry(lp->index, item);
+		if(pSearch != NULL)
+		{
+			pSearch->prev->next = pSearch->next;
+			pSearch->next->prev = pSearch->prev;
+			removeEntry(lp->index, pSearch->data, pSearch);
+			freeNode(pSearch);
+			lp->count--;
+		}
+		return;
+	}
 	for(i = 0; i < lp->count; i++)
 	{
 		if(lp->compare(pSearch->data, item) == 0)
 		{
 			pSearch->prev->next = pSearch->next;
 			pSearch->next->prev = pSearch->prev;
-			free(pSearch);
+			freeNode(pSearch);
 			lp->count--;
 			break;
 		}
@@ -206,13 +296,18 @@ void removeItem(LIST *lp, void *item)
 }
 
 /*
- * Find Item Function: Traverses the list, returns and item if that is in the list and NULL if it is not in the list.
+ * Find Item Function: Traverses the list, returns and item if that is in the list and NULL if it is not in the list. An indexed list looks the item up in its index instead.
  *
- * Big-O Notation: O(n)
+ * Big-O Notation: O(n), O(1) average if indexed
  */
 void *findItem(LIST *lp, void *item)
 {
 	assert(lp != NULL);
+	if(lp->index != NULL)
+	{
+		NODE *np = findEntry(lp->index, item);
+		return np != NULL ? np->data : NULL;
+	}
 	if(lp->count > 0)
 	{
 		NODE *pSearch;
@@ -229,6 +324,92 @@ void *findItem(LIST *lp, void *item)
 	return NULL;
 }
 
+/*
+ * Find Items Function: Sets found[i] to findItem(lists[i], items[i]) for each of the n searches. Up to GROUP searches are walked at once, each as a small state machine that prefetches the next thing it must read, its list, then a node, then that node's item, and then gives way to the next search, so that the cache misses of the different searches overlap instead of following one another. An indexed list is searched through its index at once.
+ *
+ * Big-O Notation: O(n) per search
+ */
+void findItems(LIST *lists[], void *items[], void *found[], int n)
+{
+	struct
+	{
+		int which; //search being walked, or -1 if none
+		int stage; //0: list fetched, 1: node fetched, 2: item fetched
+		NODE *np;
+	}st[GROUP];
+	int next = 0, active = 0, s;
+	LIST *lp;
+
+	for(s = 0; s < GROUP; s++)
+	{
+		st[s].which = -1;
+		if(next < n)
+		{
+			st[s].which = next++;
+			st[s].stage = 0;
+			__builtin_prefetch(lists[st[s].which]);
+			active++;
+		}
+	}
+
+	while(active > 0)
+	{
+		for(s = 0; s < GROUP; s++)
+		{
+			int i = st[s].which;
+			bool finished = false;
+			if(i == -1)
+				continue;
+			lp = lists[i];
+			if(st[s].stage == 0 && lp->index != NULL)
+			{
+				found[i] = findItem(lp, items[i]);
+				finished = true;
+			}
+			else if(st[s].stage == 0)
+			{
+				st[s].np = lp->head->next;
+				st[s].stage = 1;
+				__builtin_prefetch(st[s].np);
+			}
+			else if(st[s].np == lp->head)
+			{
+				found[i] = NULL;
+				finished = true;
+			}
+			else if(st[s].stage == 1)
+			{
+				st[s].stage = 2;
+				__builtin_prefetch(st[s].np->data);
+				__builtin_prefetch(st[s].np->next);
+			}
+			else if((*lp->compare)(st[s].np->data, items[i]) == 0)
+			{
+				found[i] = st[s].np->data;
+				finished = true;
+			}
+			else
+			{
+				st[s].np = st[s].np->next;
+				st[s].stage = 1;
+			}
+
+			if(finished)
+			{
+				st[s].which = -1;
+				active--;
+				if(next < n)
+				{
+					st[s].which = next++;
+					st[s].stage = 0;
+					__builtin_prefetch(lists[st[s].which]);
+					active++;
+				}
+			}
+		}
+	}
+}
+
 /*
  * Get Items Function: Creates array of elements and returns the array.
  *
@@ -248,3 +429,50 @@ void *getItems(LIST *lp)
 	}
 	return data;
 }
+
+/*
+ * Visit Items Function: Calls visit(item, arg) on each item from first to last, walking the nodes in place.
+ *
+ * Big-O Notation: O(n)
+ */
+void visitItems(LIST *lp, void (*visit)(), void *arg)
+{
+	assert(lp != NULL && visit != NULL);
+	NODE *pSearch = lp->head->next;
+	while(pSearch != lp->head)
+	{
+		(*visit)(pSearch->data, arg);
+		pSearch = pSearch->next;
+	}
+}
+
+/*
+ * Append List Function: Moves every item of src to the end of dst, in order, leaving src empty. The nodes are relinked rather than copied, so no node is allocated or freed, but if dst is indexed each moved node must be added to its index.
+ *
+ * Big-O Notation: O(1), O(m) if either list is indexed
+ */
+void appendList(LIST *dst, LIST *src)
+{
+	assert(dst != NULL && src != NULL && dst != src);
+	if(src->count == 0)
+		return;
+	NODE *first = src->head->next;
+	NODE *last = src->head->prev;
+	NODE *np;
+
+	if(src->index != NULL)
+		clearIndex(src->index);
+	if(dst->index != NULL)
+		for(np = first; np != src->head; np = np->next)
+			addEntry(dst->index, np->data, np);
+
+	first->prev = dst->head->prev;
+	dst->head->prev->next = first;
+	last->next = dst->head;
+	dst->head->prev = last;
+	dst->count += src->count;
+
+	src->head->next = src->head;
+	src->head->prev = src->head;
+	src->count = 0;
+}
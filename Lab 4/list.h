@@ -7,7 +7,15 @@
  *		declarations for a list abstract data type for generic
  *		pointer types.  The list supports deque operations, in
  *		which items can be easily added to or removed from the
- *		front or rear of the list.
+ *		front or rear of the list.  A list made by
+ *		createIndexedList also keeps a hash index of its items,
+ *		so that findItem and removeItem take constant time on
+ *		average instead of traversing the list.  With equal
+ *		items in such a list, they find any one of them rather
+ *		than the first.  findItems does the work of findItem for
+ *		many lists at once, setting found[i] to the result of
+ *		findItem(lists[i], items[i]), and overlaps the cache misses
+ *		of the separate searches.
  */
 
 # ifndef LIST_H
@@ -17,6 +25,8 @@ typedef struct list LIST;
 
 extern LIST *createList(int (*compare)());
 
+extern LIST *createIndexedList(int (*compare)(), unsigned (*hash)());
+
 extern void destroyList(LIST *lp);
 
 extern int numItems(LIST *lp);
@@ -37,6 +47,12 @@ extern void removeItem(LIST *lp, void *item);
 
 extern void *findItem(LIST *lp, void *item);
 
+extern void findItems(LIST *lists[], void *items[], void *found[], int n);
+
 extern void *getItems(LIST *lp);
 
+extern void visitItems(LIST *lp, void (*visit)(), void *arg);
+
+extern void appendList(LIST *dst, LIST *src);
+
 # endif /* LIST_H */
@@ -9,35 +9,66 @@
  *              The program takes a single file as a command line argument.
  *              A set is used to maintain a collection of words that occur
  *              an odd number of times.  The counts of total words and
- *              words appearing an odd number of times are printed.
+ *              words appearing an odd number of times are printed.  Words
+ *              are read BATCH at a time and looked up together with
+ *              findElements.
  */
 
 # include <stdio.h>
 # include <stdlib.h>
 # include <string.h>
+# include <stdbool.h>
 # include "set.h"
+# include "hash.h"
 
 
 /* This is sufficient for the test cases in /scratch/coen12. */
 
 # define MAX_SIZE 18000
+# define BATCH 16
 
 
 /*
- * Function:    strhash
+ * Function:    readWords
  *
- * Description: Return a hash value for a string S.
+ * Description: Read up to N words from FP into the buffers of BATCH and
+ *		return the number read.
  */
 
-static unsigned strhash(char *s)
+static int readWords(FILE *fp, char *batch[], int n)
 {
-    unsigned hash = 0;
+    int i;
 
 
-    while (*s != '\0')
-        hash = 31 * hash + *s ++;
+    for (i = 0; i < n; i ++)
+	if (fscanf(fp, "%s", batch[i]) != 1)
+	    break;
 
-    return hash;
+    return i;
+}
+
+
+/*
+ * Function:    repeated
+ *
+ * Description: Return whether the lookup of the Kth word of BATCH, whose
+ *		result is in FOUND, may have been changed by handling an
+ *		earlier word of the batch.  That is the case if an earlier
+ *		word found the same element or if neither found one and the
+ *		words are equal.
+ */
+
+static bool repeated(char *batch[], void *found[], int k)
+{
+    int i;
+
+
+    for (i = 0; i < k; i ++)
+	if (found[i] == found[k] &&
+		(found[k] != NULL || strcmp(batch[i], batch[k]) == 0))
+	    return true;
+
+    return false;
 }
 
 
@@ -50,9 +81,11 @@ static unsigned strhash(char *s)
 int main(int argc, char *argv[])
 {
     FILE *fp;
-    char buffer[BUFSIZ], *word;
+    char buffers[BATCH][BUFSIZ], *batch[BATCH], *word;
+    void *found[BATCH];
     SET *odd;
-    int words;
+    HASHFN hash;
+    int i, n, words;
 
 
     /* Check usage and open the file. */
@@ -67,20 +100,34 @@ int main(int argc, char *argv[])
         exit(EXIT_FAILURE);
     }
 
+    if ((hash = findHash(getenv("HASH"))) == NULL) {
+	fprintf(stderr, "%s: unknown hash %s\n", argv[0], getenv("HASH"));
+	exit(EXIT_FAILURE);
+    }
+
 
     /* Insert or delete words to compute their parity. */
 
     words = 0;
-    odd = createSet(MAX_SIZE, strcmp, strhash);
+    odd = createSet(MAX_SIZE, strcmp, hash);
+
+    for (i = 0; i < BATCH; i ++)
+	batch[i] = buffers[i];
+
+    while ((n = readWords(fp, batch, BATCH)) > 0) {
+	words += n;
+	findElements(odd, (void **) batch, found, n);
 
-    while (fscanf(fp, "%s", buffer) == 1) {
-        words ++;
+	for (i = 0; i < n; i ++) {
+	    word = repeated(batch, found, i) ? findElement(odd, batch[i])
+		: found[i];
 
-        if ((word = findElement(odd, buffer)) != NULL) {
-            removeElement(odd, buffer);
-	    free(word);
-	} else
-            addElement(odd, strdup(buffer));
+	    if (word != NULL) {
+		removeElement(odd, batch[i]);
+		free(word);
+	    } else
+		addElement(odd, strdup(batch[i]));
+	}
     }
 
     printf("%d total words\n", words);
@@ -0,0 +1,125 @@
+/*
+ * File:        probes.c
+ *
+ * Description: This file contains the main function for measuring the
+ *              chain lengths of a set implemented using a hash table with
+ *              chaining.
+ *
+ *              The program takes a single file as a command line argument
+ *              and runs the same workload as parity: each word is removed
+ *              from the set if present and added otherwise, so slots are
+ *              constantly being vacated and reused.  The distribution of
+ *              the number of comparisons made by successful searches and
+ *              of the number of elements in each bucket is then printed,
+ *              along with the mean of each.
+ */
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include "set.h"
+# include "hash.h"
+# include "probe.h"
+
+
+/* This is sufficient for the test cases in /scratch/coen12. */
+
+# define MAX_SIZE 18000
+
+# define MAX_PROBES 32
+
+
+/*
+ * Function:    mean
+ *
+ * Description: Return the mean length given a distribution COUNTS with N
+ *		entries.  The last entry is a lower bound.
+ */
+
+static double mean(long counts[], int n)
+{
+    long total, weighted;
+    int i;
+
+
+    total = weighted = 0;
+
+    for (i = 0; i < n; i ++) {
+	total += counts[i];
+	weighted += counts[i] * i;
+    }
+
+    return total > 0 ? (double) weighted / total : 0;
+}
+
+
+/*
+ * Function:    main
+ *
+ * Description: Driver function for the test application.
+ */
+
+int main(int argc, char *argv[])
+{
+    FILE *fp;
+    char buffer[BUFSIZ], *word;
+    long hits[MAX_PROBES], chains[MAX_PROBES], buckets;
+    SET *odd;
+    HASHFN hash;
+    int i;
+
+
+    /* Check usage and open the file. */
+
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s file1\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    if ((fp = fopen(argv[1], "r")) == NULL) {
+        fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[1]);
+        exit(EXIT_FAILURE);
+    }
+
+    if ((hash = findHash(getenv("HASH"))) == NULL) {
+	fprintf(stderr, "%s: unknown hash %s\n", argv[0], getenv("HASH"));
+	exit(EXIT_FAILURE);
+    }
+
+
+    /* Insert or delete words to compute their parity. */
+
+    odd = createSet(MAX_SIZE, strcmp, hash);
+
+    while (fscanf(fp, "%s", buffer) == 1) {
+        if ((word = findElement(odd, buffer)) != NULL) {
+            removeElement(odd, buffer);
+	    free(word);
+	} else
+            addElement(odd, strdup(buffer));
+    }
+
+    fclose(fp);
+
+
+    /* Print the distributions. */
+
+    probeLengths(odd, hits, chains, MAX_PROBES);
+
+    for (i = buckets = 0; i < MAX_PROBES; i ++)
+	buckets += chains[i];
+
+    printf("%d words occur an odd number of times\n", numElements(odd));
+    printf("%ld buckets in the table\n\n", buckets);
+    printf("length        hits      chains\n");
+
+    for (i = 0; i < MAX_PROBES; i ++)
+	printf("%6d%s %10ld  %10ld\n", i, i < MAX_PROBES - 1 ? " " : "+",
+	    hits[i], chains[i]);
+
+    printf("  mean %10.2f  %10.2f\n", mean(hits, MAX_PROBES),
+	mean(chains, MAX_PROBES));
+
+    destroySet(odd);
+    exit(EXIT_SUCCESS);
+}
@@ -7,7 +7,7 @@
  *		standard input and sort then using radix sort.  Each
  *		integer in the list is dropped into a bucket by its least
  *		significant digit.  After all integers are placed in
- *		buckets, the buckets are copied back into the list and we
+ *		buckets, the buckets are appended back onto the list and we
  *		repeat the process, but with the next most significant
  *		digit.  After all digits have been processed, the list is
  *		sorted!  Since the buckets need to preserve the order of
@@ -77,11 +77,11 @@ int main(void)
 	}
 
 
-	/* Move the numbers from the buckets back into the list. */
+	/* Move the numbers from the buckets back into the list, appending
+	   each bucket whole. */
 
 	for (i = 0; i < r; i ++)
-	    while (numItems(lists[i]) > 0)
-		addLast(a, removeFirst(lists[i]));
+	    appendList(a, lists[i]);
 
 	div = div * r;
     }
@@ -14,16 +14,72 @@
 #include <assert.h>
 #include "list.h"
 #include "set.h"
+#include "probe.h"
 #define average 20
+#define BATCH 64 //elements findElements passes to findItems at once
+#ifndef MAX_LOAD
+#define MAX_LOAD 2 //mean chain length past which a bucket is split
+#endif
 
 typedef struct set{
 	int count;
 	int length;
+	int size; //lists allocated
+	int limit; //buckets at the start of this round of splits
+	int split; //next bucket to split
 	LIST **lists;
 	int(*compare)();
 	unsigned (*hash)();
 }SET;
 
+/*
+ * Locate Function: Returns the bucket for hash value h. Buckets before split have already been split this round, so their elements are spread over twice as many buckets.
+ *
+ * Big-O Notation: O(1)
+ */
+static int locate(SET *sp, unsigned h)
+{
+	int i = h % sp->limit;
+	if(i < sp->split)
+		i = h % (2*sp->limit);
+	return i;
+}
+
+/*
+ * Split Bucket Function: Splits the next bucket in turn, as in linear hashing, moving the elements that now belong in the new last bucket into it. Only one chain is rehashed at a time, and the array of lists is doubled when it is full.
+ *
+ * Big-O Notation: O(1) amortized
+ */
+static void splitBucket(SET *sp)
+{
+	LIST *old, *new;
+	void *elt;
+	int i, n;
+	if(sp->length == sp->size)
+	{
+		sp->size *= 2;
+		sp->lists = realloc(sp->lists, sizeof(LIST*)*sp->size);
+		assert(sp->lists != NULL);
+	}
+	old = sp->lists[sp->split];
+	new = sp->lists[sp->length] = createList(sp->compare);
+	n = numItems(old);
+	for(i = 0; i < n; i++)
+	{
+		elt = removeFirst(old);
+		if((*sp->hash)(elt) % (2*sp->limit) == sp->split)
+			addLast(old, elt);
+		else
+			addLast(new, elt);
+	}
+	sp->length++;
+	if(++sp->split == sp->limit)
+	{
+		sp->split = 0;
+		sp->limit *= 2;
+	}
+}
+
 /*
  * Search Function: Utilize hash function to return index of element.
  *
@@ -32,7 +88,7 @@ typedef struct set{
 int search(SET *sp, bool *found, void *elt)
 {
 	assert(sp != NULL && elt != NULL);
-	int i = (*sp->hash)(elt) % sp->length;
+	int i = locate(sp, (*sp->hash)(elt));
 	if(findItem(sp->lists[i], elt) != NULL)
 	{
 		*found = true;
@@ -42,7 +98,7 @@ int search(SET *sp, bool *found, void *elt)
 }
 
 /*
- * Create Set Function: Initializes the list.
+ * Create Set Function: Initializes the list, with one bucket for every average of the maxElts elements. More buckets are added as elements are.
  *
  * Big-O Notation: O(n)
  */
@@ -53,8 +109,11 @@ SET *createSet(int maxElts, int (*compare)(), unsigned (*hash)())
 	sp->compare = compare;
 	sp->count = 0;
 	sp->hash = hash;
-	sp->length = maxElts / average;
-	sp->lists = malloc(sizeof(LIST*)*sp->length);
+	sp->length = maxElts / average > 0 ? maxElts / average : 1;
+	sp->size = sp->limit = sp->length;
+	sp->split = 0;
+	sp->lists = malloc(sizeof(LIST*)*sp->size);
+	assert(sp->lists != NULL);
 	int i;
 	for(i = 0; i < sp->length; i++)
 		sp->lists[i] = createList(sp->compare);
@@ -62,12 +121,16 @@ SET *createSet(int maxElts, int (*compare)(), unsigned (*hash)())
 }
 
 /*
- * Destroy Set Function: Destroys the SET sp.
+ * Destroy Set Function: Destroys the SET sp and its lists.
  *
- * Big-O Notation: O(1)
+ * Big-O Notation: O(m)
  */
 void destroySet(SET *sp)
 {
+	assert(sp != NULL);
+	int i;
+	for(i = 0; i < sp->length; i++)
+		destroyList(sp->lists[i]);
 	free(sp->lists);
 	free(sp);
 }
@@ -84,32 +147,34 @@ int numElements(SET *sp)
 }
 
 /*
- * Add Element Function: Adds an element to SET sp.
+ * Add Element Function: Adds an element to SET sp, splitting a bucket if the mean chain length is then past MAX_LOAD.
  *
- * Big-O Notation: O(n)
+ * Big-O Notation: O(1) average
  */
 void addElement(SET *sp, void *elt)
 {
 	int locn;
 	assert(sp != NULL && elt != NULL);
-	locn = (*sp->hash)(elt) % sp->length;
+	locn = locate(sp, (*sp->hash)(elt));
 	if(!findItem(sp->lists[locn], elt))
 	{
 		addFirst(sp->lists[locn], elt);
 		sp->count++;
+		if(sp->count > MAX_LOAD*sp->length)
+			splitBucket(sp);
 	}
 }
 
 /*
  * Remove Element Function: Removes an element from the SET sp.
  *
- * Big-O Notation: O(n)
+ * Big-O Notation: O(1) average
  */
 void removeElement(SET *sp, void *elt)
 {
 	int locn;
 	assert(sp != NULL && elt != NULL);
-	locn = (*sp->hash)(elt) % sp->length;
+	locn = locate(sp, (*sp->hash)(elt));
 
 	if(findItem(sp->lists[locn], elt))
 	{
@@ -121,15 +186,41 @@ void removeElement(SET *sp, void *elt)
 /*
  * Find Element Function: Finds the index of elt.
  *
- * Big-O Notation: O(n)
+ * Big-O Notation: O(1) average
  */
 void *findElement(SET *sp, void *elt)
 {
 	int locn;
-	locn = (*sp->hash)(elt) % sp->length;
+	locn = locate(sp, (*sp->hash)(elt));
 	return findItem(sp->lists[locn], elt);
 }
 
+/*
+ * Find Elements Function: Sets found[i] to the element of SET sp equal to elts[i], or NULL, for each of the n elements. The elements, then the slots of their buckets, are prefetched BATCH at a time, and the buckets are then searched together by findItems, which interleaves the walks along their chains.
+ *
+ * Big-O Notation: O(1) average per element
+ */
+void findElements(SET *sp, void *elts[], void *found[], int n)
+{
+	assert(sp != NULL && n >= 0);
+	LIST *lists[BATCH];
+	int i, j, m, locns[BATCH];
+	for(i = 0; i < n; i += m)
+	{
+		m = n - i < BATCH ? n - i : BATCH;
+		for(j = 0; j < m; j++)
+			__builtin_prefetch(elts[i + j]);
+		for(j = 0; j < m; j++)
+		{
+			locns[j] = locate(sp, (*sp->hash)(elts[i + j]));
+			__builtin_prefetch(&sp->lists[locns[j]]);
+		}
+		for(j = 0; j < m; j++)
+			lists[j] = sp->lists[locns[j]];
+		findItems(lists, elts + i, found + i, m);
+	}
+}
+
 /*
  * Get Elements Function: Returns array of the data of SET sp.
  *
@@ -150,6 +241,40 @@ void *getElements(SET *sp)
 			data[k] = items[j];
 			k++;
 		}
+		free(items);
 	}
 	return data;
 }
+
+/*
+ * Visit Elements Function: Calls visit(elt, arg) on each element of SET sp, walking each chain in place.
+ *
+ * Big-O Notation: O(n)
+ */
+void visitElements(SET *sp, void (*visit)(), void *arg)
+{
+	assert(sp != NULL && visit != NULL);
+	int i;
+	for(i = 0; i < sp->length; i++)
+		visitItems(sp->lists[i], visit, arg);
+}
+
+/*
+ * Probe Lengths Function: Fills in hits and misses, each with n entries, with the distribution of chain lengths in sp. hits[i] is the number of elements that are found after i comparisons, and misses[i] is the number of buckets holding i elements, which is the number of comparisons an unsuccessful search of that bucket makes. Longer chains are counted in the last entry.
+ *
+ * Big-O Notation: O(m)
+ */
+void probeLengths(SET *sp, long hits[], long misses[], int n)
+{
+	assert(sp != NULL && n > 0);
+	int i, j, k;
+	for(i = 0; i < n; i++)
+		hits[i] = misses[i] = 0;
+	for(i = 0; i < sp->length; i++)
+	{
+		k = numItems(sp->lists[i]);
+		misses[k < n ? k : n - 1]++;
+		for(j = 1; j <= k; j++)
+			hits[j < n ? j : n - 1]++;
+	}
+}
@@ -6,7 +6,9 @@
  * Description: This file contains the public function and type
  *              declarations for a set abstract data type for generic
  *              pointer types.  A set is an unordered collection of
- *              distinct elements.
+ *              distinct elements.  findElements looks up many elements
+ *              at once, setting found[i] to findElement(sp, elts[i]), so
+ *              that the cache misses of the separate lookups can overlap.
  */
 
 # ifndef SET_H
@@ -26,6 +28,10 @@ void removeElement(SET *sp, void *elt);
 
 void *findElement(SET *sp, void *elt);
 
+void findElements(SET *sp, void *elts[], void *found[], int n);
+
 void *getElements(SET *sp);
 
+void visitElements(SET *sp, void (*visit)(), void *arg);
+
 # endif /* SET_H */
@@ -0,0 +1,407 @@
+/*
+ * File: ulist.c
+ *
+ * Description: Contains an unrolled implementation of the list in list.h, which can be used in place of list.c by building with "make LIST=ulist.o". Items are kept in blocks of SLOTS pointers that are linked together, with the items of each block held contiguously between its lo and hi slots and no block empty unless it is the only one, so a search or a copy walks through whole cache lines instead of following one pointer per item. Adding or removing at either end touches only the first or last block, and the list keeps one emptied block aside so that a list used as a queue does not allocate on every block it passes through.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <assert.h>
+#include "list.h"
+#include "index.h"
+
+#define SLOTS 32
+
+typedef struct block
+{
+	struct block *prev;
+	struct block *next;
+	int lo; //first slot in use
+	int hi; //one past the last slot in use
+	void *slots[SLOTS];
+}BLOCK;
+
+typedef struct list
+{
+	int count;
+	BLOCK *head; //first block
+	BLOCK *tail; //last block
+	BLOCK *spare; //emptied block kept for reuse, or NULL
+	int(*compare)();
+	INDEX *index; //maps items to their blocks, or NULL if not indexed
+}LIST;
+
+/*
+ * New Block Function: Returns the spare block of the list, or a new one if there is none, with its items starting at slot start.
+ *
+ * Big-O Notation: O(1)
+ */
+static BLOCK *newBlock(LIST *lp, int start)
+{
+	BLOCK *bp = lp->spare;
+	if(bp != NULL)
+		lp->spare = NULL;
+	else
+	{
+		bp = malloc(sizeof(BLOCK));
+		assert(bp != NULL);
+	}
+	bp->prev = bp->next = NULL;
+	bp->lo = bp->hi = start;
+	return bp;
+}
+
+/*
+ * Drop Block Function: Unlinks the empty block bp from the list and keeps it as the spare, freeing the old spare if there was one. The last block of a list is never dropped, but is emptied to the middle so that it can grow at both ends.
+ *
+ * Big-O Notation: O(1)
+ */
+static void dropBlock(LIST *lp, BLOCK *bp)
+{
+	if(lp->head == lp->tail)
+	{
+		bp->lo = bp->hi = SLOTS / 2;
+		return;
+	}
+	if(bp->prev != NULL)
+		bp->prev->next = bp->next;
+	else
+		lp->head = bp->next;
+	if(bp->next != NULL)
+		bp->next->prev = bp->prev;
+	else
+		lp->tail = bp->prev;
+	free(lp->spare);
+	lp->spare = bp;
+}
+
+/*
+ * Create List Function: Initializes the list. Its first block is not allocated until an item is added, since the set in set.c creates many lists that stay empty.
+ *
+ * Big-O Notation: O(1)
+ */
+LIST *createList(int (*compare)())
+{
+	LIST *lp = malloc(sizeof(LIST));
+	assert(lp != NULL);
+	lp->compare = compare;
+	lp->count = 0;
+	lp->spare = NULL;
+	lp->head = lp->tail = NULL;
+	lp->index = NULL;
+	return lp;
+}
+
+/*
+ * Create Indexed List Function: Initializes a list that also keeps a hash index from its items to their blocks. An item never leaves its block until it is removed, since items are only shifted within a block, so findItem and removeItem need only scan the one block the index names.
+ *
+ * Big-O Notation: O(1)
+ */
+LIST *createIndexedList(int (*compare)(), unsigned (*hash)())
+{
+	LIST *lp = createList(compare);
+	lp->index = createIndex(compare, hash);
+	return lp;
+}
+
+/*
+ * Destroy List Function: Destroys the list and its blocks.
+ *
+ * Big-O Notation: O(n)
+ */
+void destroyList(LIST *lp)
+{
+	assert(lp != NULL);
+	BLOCK *bp, *pNext;
+	for(bp = lp->head; bp != NULL; bp = pNext)
+	{
+		pNext = bp->next;
+		free(bp);
+	}
+	free(lp->spare);
+	if(lp->index != NULL)
+		destroyIndex(lp->index);
+	free(lp);
+}
+
+/*
+ * Num Items Function: Returns the count of the list.
+ *
+ * Big-O Notation: O(1)
+ */
+int numItems(LIST *lp)
+{
+	assert(lp != NULL);
+	return lp->count;
+}
+
+/*
+ * Add First Function: Adds an item to the beginning of list, in front of the first block if it has no room before its items.
+ *
+ * Big-O Notation: O(1)
+ */
+void addFirst(LIST *lp, void *item)
+{
+	assert(lp != NULL);
+	BLOCK *bp = lp->head;
+	if(bp == NULL || bp->lo == 0)
+	{
+		bp = newBlock(lp, bp == NULL ? SLOTS / 2 : SLOTS);
+		bp->next = lp->head;
+		if(lp->head != NULL)
+			lp->head->prev = bp;
+		else
+			lp->tail = bp;
+		lp->head = bp;
+	}
+	bp->slots[--bp->lo] = item;
+	if(lp->index != NULL)
+		addEntry(lp->index, item, bp);
+	lp->count++;
+}
+
+/*
+ * Add Last Function: Adds an item to the end of the list, after the last block if it has no room after its items.
+ *
+ * Big-O Notation: O(1)
+ */
+void addLast(LIST *lp, void *item)
+{
+	assert(lp != NULL && item != NULL);
+	BLOCK *bp = lp->tail;
+	if(bp == NULL || bp->hi == SLOTS)
+	{
+		bp = newBlock(lp, bp == NULL ? SLOTS / 2 : 0);
+		bp->prev = lp->tail;
+		if(lp->tail != NULL)
+			lp->tail->next = bp;
+		else
+			lp->head = bp;
+		lp->tail = bp;
+	}
+	bp->slots[bp->hi++] = item;
+	if(lp->index != NULL)
+		addEntry(lp->index, item, bp);
+	lp->count++;
+}
+
+/*
+ * Remove First Function: Removes the first element from the list.
+ *
+ * Big-O Notation: O(1)
+ */
+void *removeFirst(LIST *lp)
+{
+	assert(lp != NULL && lp->count > 0);
+	BLOCK *bp = lp->head;
+	void *item = bp->slots[bp->lo++];
+	if(lp->index != NULL)
+		removeEntry(lp->index, item, bp);
+	lp->count--;
+	if(bp->lo == bp->hi)
+		dropBlock(lp, bp);
+	return item;
+}
+
+/*
+ * Remove Last Function: Removes the last element from the list.
+ *
+ * Big-O Notation: O(1)
+ */
+void *removeLast(LIST *lp)
+{
+	assert(lp != NULL && lp->count > 0);
+	BLOCK *bp = lp->tail;
+	void *item = bp->slots[--bp->hi];
+	if(lp->index != NULL)
+		removeEntry(lp->index, item, bp);
+	lp->count--;
+	if(bp->lo == bp->hi)
+		dropBlock(lp, bp);
+	return item;
+}
+
+/*
+ * Get First Function: Retrieves the first element and returns said first element.
+ *
+ * Big-O Notation: O(1)
+ */
+void *getFirst(LIST *lp)
+{
+	assert(lp != NULL && lp->count > 0);
+	return lp->head->slots[lp->head->lo];
+}
+
+/*
+ * Get Last Function: Retrieves the last element and returns said last element.
+ *
+ * Big-O Notation: O(1)
+ */
+void *getLast(LIST *lp)
+{
+	assert(lp != NULL && lp->count > 0);
+	return lp->tail->slots[lp->tail->hi - 1];
+}
+
+/*
+ * Remove Item Function: Removes an item from list, closing the gap by moving the items on whichever side of it in its block is shorter. An indexed list scans only the block its index names.
+ *
+ * Big-O Notation: O(n), O(1) average if indexed
+ */
+void removeItem(LIST *lp, void *item)
+{
+	assert(lp != NULL);
+	BLOCK *bp, *last = NULL;
+	int i;
+	bp = lp->head;
+	if(lp->index != NULL)
+	{
+		bp = last = findEntry(lp->index, item);
+		if(bp == NULL)
+			return;
+	}
+	for(; bp != NULL; bp = bp == last ? NULL : bp->next)
+	{
+		for(i = bp->lo; i < bp->hi; i++)
+		{
+			if((*lp->compare)(bp->slots[i], item) == 0)
+			{
+				if(lp->index != NULL)
+					removeEntry(lp->index, bp->slots[i], bp);
+				if(i - bp->lo < bp->hi - i - 1)
+				{
+					memmove(&bp->slots[bp->lo + 1], &bp->slots[bp->lo], sizeof(void *)*(i - bp->lo));
+					bp->lo++;
+				}
+				else
+				{
+					memmove(&bp->slots[i], &bp->slots[i + 1], sizeof(void *)*(bp->hi - i - 1));
+					bp->hi--;
+				}
+				lp->count--;
+				if(bp->lo == bp->hi)
+					dropBlock(lp, bp);
+				return;
+			}
+		}
+	}
+}
+
+/*
+ * Find Item Function: Scans the items of each block in turn, returns and item if that is in the list and NULL if it is not in the list. An indexed list scans only the block its index names.
+ *
+ * Big-O Notation: O(n), O(1) average if indexed
+ */
+void *findItem(LIST *lp, void *item)
+{
+	assert(lp != NULL);
+	BLOCK *bp, *last = NULL;
+	int i;
+	bp = lp->head;
+	if(lp->index != NULL)
+	{
+		bp = last = findEntry(lp->index, item);
+		if(bp == NULL)
+			return NULL;
+	}
+	for(; bp != NULL; bp = bp == last ? NULL : bp->next)
+	{
+		for(i = bp->lo; i < bp->hi; i++)
+		{
+			if((*lp->compare)(bp->slots[i], item) == 0)
+				return bp->slots[i];
+		}
+	}
+	return NULL;
+}
+
+/*
+ * Find Items Function: Sets found[i] to findItem(lists[i], items[i]) for each of the n searches. Every list is prefetched first, so their misses overlap, and each search then scans whole blocks as findItem does.
+ *
+ * Big-O Notation: O(n) per search
+ */
+void findItems(LIST *lists[], void *items[], void *found[], int n)
+{
+	int i;
+	for(i = 0; i < n; i++)
+		__builtin_prefetch(lists[i]);
+	for(i = 0; i < n; i++)
+		found[i] = findItem(lists[i], items[i]);
+}
+
+/*
+ * Get Items Function: Creates array of elements and returns the array, copying each block's items at once.
+ *
+ * Big-O Notation: O(n)
+ */
+void *getItems(LIST *lp)
+{
+	assert(lp != NULL);
+	void **data = malloc(sizeof(void *)*(lp->count > 0 ? lp->count : 1));
+	assert(data != NULL);
+	BLOCK *bp;
+	int i = 0;
+	for(bp = lp->head; bp != NULL; bp = bp->next)
+	{
+		memcpy(data + i, &bp->slots[bp->lo], sizeof(void *)*(bp->hi - bp->lo));
+		i += bp->hi - bp->lo;
+	}
+	return data;
+}
+
+/*
+ * Visit Items Function: Calls visit(item, arg) on each item from first to last, walking the blocks in place.
+ *
+ * Big-O Notation: O(n)
+ */
+void visitItems(LIST *lp, void (*visit)(), void *arg)
+{
+	assert(lp != NULL && visit != NULL);
+	BLOCK *bp;
+	int i;
+	for(bp = lp->head; bp != NULL; bp = bp->next)
+	{
+		for(i = bp->lo; i < bp->hi; i++)
+			(*visit)(bp->slots[i], arg);
+	}
+}
+
+/*
+ * Append List Function: Moves every item of src to the end of dst, in order, leaving src empty. The blocks of src are linked on after those of dst as they are, so no item is copied, but if dst is indexed each moved item must be added to its index. An empty block left in dst is kept as its spare.
+ *
+ * Big-O Notation: O(1), O(m) if either list is indexed
+ */
+void appendList(LIST *dst, LIST *src)
+{
+	assert(dst != NULL && src != NULL && dst != src);
+	if(src->count == 0)
+		return;
+	BLOCK *bp;
+	int i;
+	if(src->index != NULL)
+		clearIndex(src->index);
+	if(dst->index != NULL)
+		for(bp = src->head; bp != NULL; bp = bp->next)
+			for(i = bp->lo; i < bp->hi; i++)
+				addEntry(dst->index, bp->slots[i], bp);
+	if(dst->count == 0)
+	{
+		if(dst->head != NULL)
+		{
+			free(dst->spare);
+			dst->spare = dst->head;
+		}
+		dst->head = src->head;
+	}
+	else
+	{
+		dst->tail->next = src->head;
+		src->head->prev = dst->tail;
+	}
+	dst->tail = src->tail;
+	dst->count += src->count;
+
+	src->head = src->tail = NULL;
+	src->count = 0;
+}
@@ -11,7 +11,8 @@
  *              are inserted into the set and the counts of total words and
  *              total words in the set are printed.  If the second file is
  *              given then all words in the second file are deleted from
- *              the set and the count printed.
+ *              the set and the count printed.  Words are read BATCH at a
+ *              time and looked up together with findElements.
  */
 
 # include <stdio.h>
@@ -19,28 +20,68 @@
 # include <string.h>
 # include <stdbool.h>
 # include "set.h"
+# include "hash.h"
 
 
 /* This is sufficient for the test cases in /scratch/coen12. */
 
 # define MAX_SIZE 18000
+# define BATCH 16
 
 
 /*
- * Function:    strhash
+ * Function:    readWords
  *
- * Description: Return a hash value for a string S.
+ * Description: Read up to N words from FP into the buffers of BATCH and
+ *		return the number read.
  */
 
-static unsigned strhash(char *s)
+static int readWords(FILE *fp, char *batch[], int n)
 {
-    unsigned hash = 0;
+    int i;
 
 
-    while (*s != '\0')
-        hash = 31 * hash + *s ++;
+    for (i = 0; i < n; i ++)
+	if (fscanf(fp, "%s", batch[i]) != 1)
+	    break;
 
-    return hash;
+    return i;
+}
+
+
+/*
+ * Function:    repeated
+ *
+ * Description: Return whether the lookup of the Kth word of BATCH, whose
+ *		result is in FOUND, may have been changed by handling an
+ *		earlier word of the batch.  That is the case if an earlier
+ *		word found the same element or if neither found one and the
+ *		words are equal.
+ */
+
+static bool repeated(char *batch[], void *found[], int k)
+{
+    int i;
+
+
+    for (i = 0; i < k; i ++)
+	if (found[i] == found[k] &&
+		(found[k] != NULL || strcmp(batch[i], batch[k]) == 0))
+	    return true;
+
+    return false;
+}
+
+
+/*
+ * Function:    printElement
+ *
+ * Description: Print the word ELT on a line of its own.
+ */
+
+static void printElement(char *elt, void *arg)
+{
+    printf("%s\n", elt);
 }
 
 
@@ -53,9 +94,11 @@ static unsigned strhash(char *s)
 int main(int argc, char *argv[])
 {
     FILE *fp;
-    char buffer[BUFSIZ], **elts, *word;
+    char buffers[BATCH][BUFSIZ], *batch[BATCH], *word;
+    void *found[BATCH];
     SET *unique;
-    int i, words;
+    HASHFN hash;
+    int i, n, words;
     bool lflag = false;
 
 
@@ -79,16 +122,28 @@ int main(int argc, char *argv[])
         exit(EXIT_FAILURE);
     }
 
+    if ((hash = findHash(getenv("HASH"))) == NULL) {
+	fprintf(stderr, "%s: unknown hash %s\n", argv[0], getenv("HASH"));
+	exit(EXIT_FAILURE);
+    }
+
 
     /* Insert all words into the set. */
 
     words = 0;
-    unique = createSet(MAX_SIZE, strcmp, strhash);
+    unique = createSet(MAX_SIZE, strcmp, hash);
 
-    while (fscanf(fp, "%s", buffer) == 1) {
-        words ++;
-	if (!findElement(unique, buffer))
-	    addElement(unique, strdup(buffer));
+    for (i = 0; i < BATCH; i ++)
+	batch[i] = buffers[i];
+
+    while ((n = readWords(fp, batch, BATCH)) > 0) {
+	words += n;
+	findElements(unique, (void **) batch, found, n);
+
+	for (i = 0; i < n; i ++)
+	    if (found[i] == NULL && (!repeated(batch, found, i) ||
+		    findElement(unique, batch[i]) == NULL))
+		addElement(unique, strdup(batch[i]));
     }
 
     fclose(fp);
@@ -110,10 +165,17 @@ int main(int argc, char *argv[])
 
         /* Delete all words in the second file. */
 
-        while (fscanf(fp, "%s", buffer) == 1) {
-	    if ((word = findElement(unique, buffer)) != NULL) {
-		removeElement(unique, buffer);
-		free(word);
+        while ((n = readWords(fp, batch, BATCH)) > 0) {
+	    findElements(unique, (void **) batch, found, n);
+
+	    for (i = 0; i < n; i ++) {
+		word = repeated(batch, found, i)
+		    ? findElement(unique, batch[i]) : found[i];
+
+		if (word != NULL) {
+		    removeElement(unique, batch[i]);
+		    free(word);
+		}
 	    }
 	}
 
@@ -127,12 +189,7 @@ int main(int argc, char *argv[])
     /* Print the list of words if desired. */
 
     if (lflag) {
-	elts = getElements(unique);
-
-	for (i = 0; i < numElements(unique); i ++)
-	    printf("%s\n", elts[i]);
-
-	free(elts);
+	visitElements(unique, printElement, NULL);
     }
 
     destroySet(unique);
@@ -0,0 +1,27 @@
+/*
+ * File:        cset.h
+ *
+ * Description: This file contains the public function declarations for a
+ *              set abstract data type for generic pointer types that may
+ *              be shared by several threads.  The set has the interface in
+ *              set.h, with the following differences.
+ *
+ *              addElement, addElements, insertElement, findElement,
+ *              findElements, removeElement, and numElements may be called
+ *              concurrently from any number of threads.  createSet,
+ *              destroySet, getElements, and visitElements may not be
+ *              called while any other operation is in progress.
+ *
+ *              The table does not grow, and a removed element's slot is
+ *              not reused, so MAXELTS must exceed the number of elements
+ *              that will ever be added.
+ */
+
+# ifndef CSET_H
+# define CSET_H
+
+# include "set.h"
+
+void *insertElement(SET *sp, void *elt);
+
+# endif /* CSET_H */
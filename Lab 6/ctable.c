@@ -0,0 +1,379 @@
+/*
+ * File:        ctable.c
+ *
+ * Description: This file contains the public and private function and type
+ *              definitions for a set abstract data type for generic
+ *              pointer types that may be shared by several threads.  A set
+ *              is an unordered collection of unique elements.
+ *
+ *              This implementation uses a hash table of fixed size with
+ *              linear probing, as in table.c, but every flag is accessed
+ *              atomically.  An insertion claims an empty slot by changing
+ *              its flag from EMPTY to BUSY with a compare-and-swap, stores
+ *              the element and its hash value, and then publishes them by
+ *              setting the flag to FILLED.  A search that meets a BUSY
+ *              slot treats it as not holding the element, since that
+ *              insertion has not yet happened as far as the search is
+ *              concerned, so findElement never waits.  An insertion that
+ *              meets a BUSY slot must wait for it to be filled, since it
+ *              may hold the same element.
+ *
+ *              A deletion changes the flag from FILLED to DELETED, again
+ *              with a compare-and-swap so that only one thread succeeds.
+ *              Deleted slots are never reused, since two threads adding
+ *              the same element could otherwise each claim a different
+ *              vacant slot.  An element may still be in use by a search
+ *              in another thread after it is deleted, so the caller must
+ *              not deallocate it until all such searches are finished.
+ */
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <assert.h>
+# include <stdbool.h>
+# include <stdatomic.h>
+# include <sched.h>
+# include "cset.h"
+# include "sort.h"
+
+# define EMPTY   0
+# define FILLED  1
+# define DELETED 2
+# define BUSY    3
+
+struct set {
+    atomic_int count;		/* number of elements in set   */
+    atomic_int used;		/* number of slots ever filled */
+    int length;			/* length of allocated arrays  */
+    void **data;		/* array of allocated elements */
+    unsigned *hashes;		/* hash value of each element  */
+    atomic_char *flags;		/* state of each slot          */
+    int (*compare)();		/* comparison function         */
+    unsigned (*hash)();		/* hash function               */
+};
+
+
+/*
+ * Function:    createSet
+ *
+ * Complexity:  O(m)
+ *
+ * Description: Return a pointer to a new set with a maximum capacity of
+ *		MAXELTS.
+ */
+
+SET *createSet(int maxElts, int (*compare)(), unsigned (*hash)())
+{
+    SET *sp;
+    int i;
+
+
+    assert(compare != NULL && hash != NULL && maxElts > 0);
+
+    sp = malloc(sizeof(SET));
+    assert(sp != NULL);
+
+    sp->data = malloc(sizeof(void *) * maxElts);
+    assert(sp->data != NULL);
+
+    sp->hashes = malloc(sizeof(unsigned) * maxElts);
+    assert(sp->hashes != NULL);
+
+    sp->flags = malloc(sizeof(atomic_char) * maxElts);
+    assert(sp->flags != NULL);
+
+    for (i = 0; i < maxElts; i ++)
+	atomic_init(&sp->flags[i], EMPTY);
+
+    atomic_init(&sp->count, 0);
+    atomic_init(&sp->used, 0);
+    sp->length = maxElts;
+    sp->compare = compare;
+    sp->hash = hash;
+    return sp;
+}
+
+
+/*
+ * Function:    destroySet
+ *
+ * Complexity:  O(1)
+ *
+ * Description: Deallocate memory associated with the set pointed to by SP.
+ *		The elements themselves are not deallocated since we did not
+ *		allocate them in the first place.
+ */
+
+void destroySet(SET *sp)
+{
+    assert(sp != NULL);
+
+    free(sp->flags);
+    free(sp->hashes);
+    free(sp->data);
+    free(sp);
+}
+
+
+/*
+ * Function:    numElements
+ *
+ * Complexity:  O(1)
+ *
+ * Description: Return the number of elements in the set pointed to by SP.
+ */
+
+int numElements(SET *sp)
+{
+    assert(sp != NULL);
+    return atomic_load(&sp->count);
+}
+
+
+/*
+ * Function:    search
+ *
+ * Complexity:  O(1) average case, O(n) worst case
+ *
+ * Description: Return the location of ELT, whose hash value is HASH, in
+ *		the set pointed to by SP, or -1 if it is not present.  Slots
+ *		that are being filled are skipped.
+ */
+
+static int search(SET *sp, void *elt, unsigned hash)
+{
+    int i, idx;
+    char flag;
+
+
+    idx = hash % sp->length;
+
+    for (i = 0; i < sp->length; i ++) {
+	flag = atomic_load_explicit(&sp->flags[idx], memory_order_acquire);
+
+	if (flag == EMPTY)
+	    return -1;
+
+	if (flag == FILLED && sp->hashes[idx] == hash &&
+		(*sp->compare)(elt, sp->data[idx]) == 0)
+	    return idx;
+
+	if (++ idx == sp->length)
+	    idx = 0;
+    }
+
+    return -1;
+}
+
+
+/*
+ * Function:    insertElement
+ *
+ * Complexity:  O(1) average case, O(n) worst case
+ *
+ * Description: Add ELT to the set pointed to by SP and return NULL, unless
+ *		an equal element is already present, in which case return
+ *		that element instead.  Of several threads adding equal
+ *		elements at once, exactly one receives NULL.
+ */
+
+void *insertElement(SET *sp, void *elt)
+{
+    unsigned hash;
+    int i, idx, used;
+    char flag;
+
+
+    assert(sp != NULL && elt != NULL);
+
+    hash = (*sp->hash)(elt);
+    idx = hash % sp->length;
+
+    for (i = 0; i < sp->length; i ++) {
+	flag = atomic_load_explicit(&sp->flags[idx], memory_order_acquire);
+
+	if (flag == EMPTY && atomic_compare_exchange_strong_explicit(
+		&sp->flags[idx], &flag, BUSY, memory_order_acquire,
+		memory_order_acquire)) {
+	    used = atomic_fetch_add(&sp->used, 1);
+	    assert(used < sp->length - 1);
+
+	    sp->data[idx] = elt;
+	    sp->hashes[idx] = hash;
+	    atomic_store_explicit(&sp->flags[idx], FILLED,
+		memory_order_release);
+
+	    atomic_fetch_add(&sp->count, 1);
+	    return NULL;
+	}
+
+	while (flag == BUSY) {
+	    sched_yield();
+	    flag = atomic_load_explicit(&sp->flags[idx],
+		memory_order_acquire);
+	}
+
+	if (flag == FILLED && sp->hashes[idx] == hash &&
+		(*sp->compare)(elt, sp->data[idx]) == 0)
+	    return sp->data[idx];
+
+	if (++ idx == sp->length)
+	    idx = 0;
+    }
+
+    assert(false);
+    return NULL;
+}
+
+
+/*
+ * Function:    addElement
+ *
+ * Complexity:  O(1) average case, O(n) worst case
+ *
+ * Description: Add ELT to the set pointed to by SP.
+ */
+
+void addElement(SET *sp, void *elt)
+{
+    insertElement(sp, elt);
+}
+
+
+/*
+ * Function:    removeElement
+ *
+ * Complexity:  O(1) average case, O(n) worst case
+ *
+ * Description: Remove ELT from the set pointed to by SP.
+ */
+
+void removeElement(SET *sp, void *elt)
+{
+    char flag;
+    int idx;
+
+
+    assert(sp != NULL && elt != NULL);
+    idx = search(sp, elt, (*sp->hash)(elt));
+
+    flag = FILLED;
+
+    if (idx != -1 && atomic_compare_exchange_strong(&sp->flags[idx], &flag,
+	    DELETED))
+	atomic_fetch_sub(&sp->count, 1);
+}
+
+
+/*
+ * Function:    findElement
+ *
+ * Complexity:  O(1) average case, O(n) worst case
+ *
+ * Description: If ELT is present in the set pointed to by SP then return
+ *		it, otherwise return NULL.  A search never waits for other
+ *		threads.
+ */
+
+void *findElement(SET *sp, void *elt)
+{
+    int idx;
+
+
+    assert(sp != NULL && elt != NULL);
+    idx = search(sp, elt, (*sp->hash)(elt));
+    return idx != -1 ? sp->data[idx] : NULL;
+}
+
+
+/*
+ * Function:    findElements
+ *
+ * Complexity:  O(n) average case, O(n^2) worst case
+ *
+ * Description: Search the set pointed to by SP for each of the N elements
+ *		ELTS, setting the corresponding entry of OUT as findElement
+ *		would return it.
+ */
+
+void findElements(SET *sp, void **elts, void **out, int n)
+{
+    int i;
+
+
+    for (i = 0; i < n; i ++)
+	out[i] = findElement(sp, elts[i]);
+}
+
+
+/*
+ * Function:    addElements
+ *
+ * Complexity:  O(n) average case, O(n^2) worst case
+ *
+ * Description: Add each of the N elements ELTS to the set pointed to by
+ *		SP, setting the corresponding entry of OUT to the element in
+ *		the set equal to it.
+ */
+
+void addElements(SET *sp, void **elts, void **out, int n)
+{
+    int i;
+
+
+    for (i = 0; i < n; i ++)
+	if ((out[i] = insertElement(sp, elts[i])) == NULL)
+	    out[i] = elts[i];
+}
+
+
+/*
+ * Function:    getElements
+ *
+ * Complexity:  O(m + n log n)
+ *
+ * Description: Allocate and return an array of elements in the set pointed
+ *		to by SP, in sorted order.
+ */
+
+void *getElements(SET *sp)
+{
+    void **elts;
+    int i, j, count;
+
+
+    assert(sp != NULL);
+
+    count = numElements(sp);
+    elts = malloc(sizeof(void *) * (count > 0 ? count : 1));
+    assert(elts != NULL);
+
+    for (i = j = 0; i < sp->length; i ++)
+	if (atomic_load(&sp->flags[i]) == FILLED)
+	    elts[j ++] = sp->data[i];
+
+    sortElements(elts, j, sp->compare);
+    return elts;
+}
+
+
+/*
+ * Function:    visitElements
+ *
+ * Complexity:  O(m)
+ *
+ * Description: Call VISIT(elt, ARG) on each element in the set pointed to
+ *		by SP, in no particular order, walking the slots in place.
+ */
+
+void visitElements(SET *sp, void (*visit)(), void *arg)
+{
+    int i;
+
+
+    assert(sp != NULL && visit != NULL);
+
+    for (i = 0; i < sp->length; i ++)
+	if (atomic_load(&sp->flags[i]) == FILLED)
+	    (*visit)(sp->data[i], arg);
+}
@@ -0,0 +1,16 @@
+/*
+ * File:        probe.h
+ *
+ * Description: This file contains the function declarations for examining
+ *              how far searches probe in a set implemented using a hash
+ *              table.  It is only used for measuring the implementations.
+ */
+
+# ifndef PROBE_H
+# define PROBE_H
+
+# include "set.h"
+
+void probeLengths(SET *sp, long hits[], long misses[], int n);
+
+# endif /* PROBE_H */
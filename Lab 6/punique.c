@@ -0,0 +1,361 @@
+/*
+ * File:        punique.c
+ *
+ * Description: This file contains the main function for testing a set
+ *              abstract data type for strings that is shared by several
+ *              threads.
+ *
+ *              The program takes the same arguments as unique, along with
+ *              the number of threads to use.  The first file is read into
+ *              memory and divided into one part per thread, and each thread
+ *              inserts the words of its part into a single shared set.  The
+ *              words of the optional second file are then deleted by the
+ *              main thread alone.
+ *
+ *              With -b, the insertions are instead timed with one thread,
+ *              then two, four, and so on up to the number given, and the
+ *              throughput and speedup of each are printed.
+ */
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <stdbool.h>
+# include <ctype.h>
+# include <time.h>
+# include <unistd.h>
+# include <pthread.h>
+# include <assert.h>
+# include "cset.h"
+# include "hash.h"
+
+# define ROUNDS 3
+
+struct part {
+    SET *set;			/* set shared by all threads   */
+    char *start;		/* first character of the part */
+    char *end;			/* one past the last character */
+    int words;			/* number of words in the part */
+};
+
+
+/*
+ * Function:    separator
+ *
+ * Description: Return whether C separates words.  Words are replaced by
+ *		null-terminated strings in place, so a null also does.
+ */
+
+static bool separator(char c)
+{
+    return c == '\0' || isspace((unsigned char) c);
+}
+
+
+/*
+ * Function:    insertWords
+ *
+ * Description: Insert each word of the part pointed to by ARG into its
+ *		set, terminating each word in place.  A word is only copied
+ *		if it is not already present, and the copy is discarded if
+ *		another thread inserts the same word first.
+ */
+
+static void *insertWords(void *arg)
+{
+    struct part *pp = arg;
+    char *p, *word, *copy;
+
+
+    pp->words = 0;
+    p = pp->start;
+
+    while (p < pp->end) {
+	while (p < pp->end && separator(*p))
+	    p ++;
+
+	if (p == pp->end)
+	    break;
+
+	word = p;
+
+	while (!separator(*p))
+	    p ++;
+
+	*p ++ = '\0';
+	pp->words ++;
+
+	if (findElement(pp->set, word) == NULL) {
+	    copy = strdup(word);
+	    assert(copy != NULL);
+
+	    if (insertElement(pp->set, copy) != NULL)
+		free(copy);
+	}
+    }
+
+    return NULL;
+}
+
+
+/*
+ * Function:    insertAll
+ *
+ * Description: Insert all words of the TEXT of SIZE characters into the
+ *		set pointed to by SP using NTHREADS threads, and return the
+ *		total number of words.  Each part ends at a separator, so
+ *		no word is split between two threads.
+ */
+
+static int insertAll(SET *sp, char *text, long size, int nthreads)
+{
+    pthread_t *threads;
+    struct part *parts;
+    char *p, *end;
+    int i, words;
+
+
+    threads = malloc(sizeof(pthread_t) * nthreads);
+    parts = malloc(sizeof(struct part) * nthreads);
+    assert(threads != NULL && parts != NULL);
+
+    p = text;
+    end = text + size;
+
+    for (i = 0; i < nthreads; i ++) {
+	parts[i].set = sp;
+	parts[i].start = p;
+	p = i < nthreads - 1 ? text + size * (i + 1) / nthreads : end;
+
+	if (p < parts[i].start)
+	    p = parts[i].start;
+
+	while (p < end && !separator(*p))
+	    p ++;
+
+	parts[i].end = p;
+
+	if (pthread_create(&threads[i], NULL, insertWords, &parts[i]) != 0) {
+	    fprintf(stderr, "punique: cannot create thread\n");
+	    exit(EXIT_FAILURE);
+	}
+    }
+
+    words = 0;
+
+    for (i = 0; i < nthreads; i ++) {
+	pthread_join(threads[i], NULL);
+	words += parts[i].words;
+    }
+
+    free(parts);
+    free(threads);
+    return words;
+}
+
+
+/*
+ * Function:    countWords
+ *
+ * Description: Return the number of words in the TEXT of SIZE characters.
+ */
+
+static int countWords(char *text, long size)
+{
+    int i, words;
+
+
+    for (i = words = 0; i < size; i ++)
+	if (!separator(text[i]) && (i == 0 || separator(text[i - 1])))
+	    words ++;
+
+    return words;
+}
+
+
+/*
+ * Function:    freeElement
+ *
+ * Description: Deallocate the element ELT.  This is passed to visitElements
+ *		to deallocate every element of a set.
+ */
+
+static void freeElement(char *elt, void *arg)
+{
+    free(elt);
+}
+
+
+/*
+ * Function:    seconds
+ *
+ * Description: Return the current value of a monotonic clock in seconds.
+ */
+
+static double seconds(void)
+{
+    struct timespec ts;
+
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+/*
+ * Function:    main
+ *
+ * Description: Driver function for the test application.
+ */
+
+int main(int argc, char *argv[])
+{
+    FILE *fp;
+    char buffer[BUFSIZ], **elts, *word, *text;
+    double start, elapsed, best, base;
+    int i, c, words, nthreads, round;
+    bool lflag = false, bflag = false;
+    HASHFN hash;
+    SET *unique;
+    long size;
+
+
+    /* Check usage and open the first file. */
+
+    nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+
+    while ((c = getopt(argc, argv, "lbt:")) != -1)
+	switch (c) {
+	case 'l':
+	    lflag = true;
+	    break;
+
+	case 'b':
+	    bflag = true;
+	    break;
+
+	case 't':
+	    nthreads = atoi(optarg);
+	    break;
+
+	default:
+	    nthreads = 0;
+	    break;
+	}
+
+    if (nthreads < 1 || argc - optind < 1 || argc - optind > 2) {
+	fprintf(stderr, "usage: %s [-l] [-b] [-t threads] file1 [file2]\n",
+	    argv[0]);
+	exit(EXIT_FAILURE);
+    }
+
+    if ((fp = fopen(argv[optind], "r")) == NULL) {
+	fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[optind]);
+	exit(EXIT_FAILURE);
+    }
+
+    if ((hash = findHash(getenv("HASH"))) == NULL) {
+	fprintf(stderr, "%s: unknown hash %s\n", argv[0], getenv("HASH"));
+	exit(EXIT_FAILURE);
+    }
+
+
+    /* Read the first file into memory and size the set to hold every
+       word in it, since the set cannot grow. */
+
+    fseek(fp, 0, SEEK_END);
+    size = ftell(fp);
+    rewind(fp);
+
+    text = malloc(size + 1);
+    assert(text != NULL);
+    size = fread(text, 1, size, fp);
+    text[size] = '\0';
+    fclose(fp);
+
+    words = countWords(text, size);
+
+
+    /* Time the insertions with increasing numbers of threads. */
+
+    if (bflag) {
+	base = 0;
+	printf("%d words\n\n", words);
+	printf("threads    seconds  Mwords/s  speedup\n");
+
+	for (i = 1; i <= nthreads; i = i < nthreads && i * 2 > nthreads
+		? nthreads : i * 2) {
+	    best = 0;
+
+	    for (round = 0; round < ROUNDS; round ++) {
+		unique = createSet(2 * words + 2, strcmp, hash);
+		start = seconds();
+		insertAll(unique, text, size, i);
+		elapsed = seconds() - start;
+		best = round == 0 || elapsed < best ? elapsed : best;
+		visitElements(unique, freeElement, NULL);
+		destroySet(unique);
+	    }
+
+	    base = i == 1 ? best : base;
+	    printf("%7d %10.4f %9.2f %8.2f\n", i, best, words / best / 1e6,
+		base / best);
+	}
+
+	free(text);
+	exit(EXIT_SUCCESS);
+    }
+
+
+    /* Insert all words into the set. */
+
+    unique = createSet(2 * words + 2, strcmp, hash);
+    words = insertAll(unique, text, size, nthreads);
+
+    if (!lflag) {
+	printf("%d total words\n", words);
+	printf("%d distinct words\n", numElements(unique));
+    }
+
+
+    /* Try to open the second file. */
+
+    if (argc - optind == 2) {
+	if ((fp = fopen(argv[optind + 1], "r")) == NULL) {
+	    fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[optind + 1]);
+	    exit(EXIT_FAILURE);
+	}
+
+
+	/* Delete all words in the second file. */
+
+	while (fscanf(fp, "%s", buffer) == 1) {
+	    if ((word = findElement(unique, buffer)) != NULL) {
+		removeElement(unique, buffer);
+		free(word);
+	    }
+	}
+
+	fclose(fp);
+
+	if (!lflag)
+	    printf("%d remaining words\n", numElements(unique));
+    }
+
+
+    /* Print the list of words if desired. */
+
+    if (lflag) {
+	elts = getElements(unique);
+
+	for (i = 0; i < numElements(unique); i ++)
+	    printf("%s\n", elts[i]);
+
+	free(elts);
+    }
+
+    visitElements(unique, freeElement, NULL);
+    destroySet(unique);
+    free(text);
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,727 @@
+/*
+ * File:        robin.c
+ *
+ * Description: This file contains the public and private function and type
+ *              definitions for a set abstract data type for generic
+ *              pointer types.  A set is an unordered collection of unique
+ *              elements.
+ *
+ *              This implementation uses a hash table with Robin Hood
+ *              hashing: linear probing in which an element being inserted
+ *              takes the slot of any element closer to its home slot than
+ *              it is, so that each run of the table is ordered by home
+ *              slot.  A search can therefore stop as soon as it reaches an
+ *              element closer to its home than the element sought would
+ *              be.  Deletion shifts the following elements of the run back
+ *              one slot instead of leaving a marker behind, so there are
+ *              never any deleted slots to probe past.
+ *
+ *              The table grows and shrinks as in table.c, draining the old
+ *              table a few slots per operation.  Since draining empties
+ *              slots, the drain only ever stops at the start of a run, so
+ *              every element of a run with its home in the drained part
+ *              of the old table has itself been moved.
+ *
+ *              As in table.c, the hash value of each element is kept
+ *              alongside it, so elements are only compared when their hash
+ *              values match and a rehash never calls the hash function.
+ */
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <assert.h>
+# include <stdbool.h>
+# include <limits.h>
+# include "set.h"
+# include "probe.h"
+# include "sort.h"
+
+# define EMPTY   -1
+
+# define STEPS	 16		/* old slots drained per operation */
+# define BATCH	 16		/* elements prefetched at once     */
+
+typedef struct table {
+    int length;                 /* length of allocated arrays  */
+    void **data;                /* array of allocated elements */
+    unsigned *hashes;           /* hash value of each element  */
+    int *dist;                  /* distance of slot from home  */
+} TABLE;
+
+struct set {
+    int count;                  /* number of elements in set   */
+    int minLength;              /* never shrink below this     */
+    int start;                  /* first old slot drained      */
+    int moved;                  /* old slots drained so far    */
+    int remaining;              /* elements left in old table  */
+    TABLE cur;                  /* table receiving insertions  */
+    TABLE old;                  /* table being drained, if any */
+    int (*compare)();		/* comparison function         */
+    unsigned (*hash)();		/* hash function               */
+};
+
+
+/*
+ * Function:    createTable
+ *
+ * Complexity:  O(m)
+ *
+ * Description: Allocate the arrays for the table pointed to by TP with
+ *		LENGTH slots, all of which are empty.
+ */
+
+static void createTable(TABLE *tp, int length)
+{
+    int i;
+
+
+    tp->data = malloc(sizeof(void *) * length);
+    assert(tp->data != NULL);
+
+    tp->hashes = malloc(sizeof(unsigned) * length);
+    assert(tp->hashes != NULL);
+
+    tp->dist = malloc(sizeof(int) * length);
+    assert(tp->dist != NULL);
+
+    tp->length = length;
+
+    for (i = 0; i < length; i ++)
+	tp->dist[i] = EMPTY;
+}
+
+
+/*
+ * Function:    destroyTable
+ *
+ * Complexity:  O(1)
+ *
+ * Description: Deallocate the arrays for the table pointed to by TP.
+ */
+
+static void destroyTable(TABLE *tp)
+{
+    free(tp->dist);
+    free(tp->hashes);
+    free(tp->data);
+
+    tp->data = NULL;
+    tp->hashes = NULL;
+    tp->dist = NULL;
+    tp->length = 0;
+}
+
+
+/*
+ * Function:    search
+ *
+ * Complexity:  O(1) average case, O(n) worst case
+ *
+ * Description: Return the location of ELT in the table pointed to by TP,
+ *		or -1 if it is not present.  The element is first hashed to
+ *		its home slot using its hash value HASH.  Subsequent slots
+ *		are examined until one is empty or holds an element that is
+ *		closer to its own home than ELT would be.  Since an empty
+ *		slot has a distance of -1, one test checks for both.
+ */
+
+static int search(SET *sp, TABLE *tp, void *elt, unsigned hash)
+{
+    int d, locn;
+
+
+    locn = hash % tp->length;
+
+    for (d = 0; tp->dist[locn] >= d; d ++) {
+	if (tp->dist[locn] == d && tp->hashes[locn] == hash &&
+		(*sp->compare)(tp->data[locn], elt) == 0)
+	    return locn;
+
+	if (++ locn == tp->length)
+	    locn = 0;
+    }
+
+    return -1;
+}
+
+
+/*
+ * Function:    insert
+ *
+ * Complexity:  O(1) average case, O(n) worst case
+ *
+ * Description: Insert ELT with hash value HASH into the table pointed to
+ *		by TP.  The caller must know that the element is not
+ *		already present.  Whenever the element being placed is
+ *		farther from its home than the resident of a slot, the two
+ *		are swapped and we go on to place the evicted element.
+ */
+
+static void insert(TABLE *tp, void *elt, unsigned hash)
+{
+    int d, locn, temp;
+    unsigned h;
+    void *swap;
+
+
+    locn = hash % tp->length;
+
+    for (d = 0; tp->dist[locn] != EMPTY; d ++) {
+	if (tp->dist[locn] < d) {
+	    swap = tp->data[locn];
+	    tp->data[locn] = elt;
+	    elt = swap;
+
+	    h = tp->hashes[locn];
+	    tp->hashes[locn] = hash;
+	    hash = h;
+
+	    temp = tp->dist[locn];
+	    tp->dist[locn] = d;
+	    d = temp;
+	}
+
+	if (++ locn == tp->length)
+	    locn = 0;
+    }
+
+    tp->data[locn] = elt;
+    tp->hashes[locn] = hash;
+    tp->dist[locn] = d;
+}
+
+
+/*
+ * Function:    delete
+ *
+ * Complexity:  O(1) average case, O(n) worst case
+ *
+ * Description: Delete the element at location LOCN in the table pointed to
+ *		by TP.  Each following element of the run that is not in its
+ *		home slot is shifted back by one, and the last slot vacated
+ *		is emptied.
+ */
+
+static void delete(TABLE *tp, int locn)
+{
+    int next;
+
+
+    next = locn + 1 < tp->length ? locn + 1 : 0;
+
+    while (tp->dist[next] > 0) {
+	tp->data[locn] = tp->data[next];
+	tp->hashes[locn] = tp->hashes[next];
+	tp->dist[locn] = tp->dist[next] - 1;
+	locn = next;
+
+	if (++ next == tp->length)
+	    next = 0;
+    }
+
+    tp->dist[locn] = EMPTY;
+}
+
+
+/*
+ * Function:    drained
+ *
+ * Complexity:  O(1)
+ *
+ * Description: Return whether the home slot for hash value HASH in the old
+ *		table of the set pointed to by SP has already been drained,
+ *		in which case the old table need not be searched.
+ */
+
+static bool drained(SET *sp, unsigned hash)
+{
+    int home;
+
+
+    home = (int) (hash % sp->old.length) - sp->start;
+
+    if (home < 0)
+	home += sp->old.length;
+
+    return home < sp->moved;
+}
+
+
+/*
+ * Function:    drain
+ *
+ * Complexity:  O(1) average case
+ *
+ * Description: Move the elements in at least STEPS slots of the old table
+ *		of the set pointed to by SP into the current table, stopping
+ *		only at the start of a run.  Once the whole old table has
+ *		been drained it is deallocated.
+ */
+
+static void drain(SET *sp, int steps)
+{
+    int locn;
+
+
+    while (sp->old.data != NULL) {
+	locn = (sp->start + sp->moved) % sp->old.length;
+
+	if (sp->old.dist[locn] != EMPTY) {
+	    insert(&sp->cur, sp->old.data[locn], sp->old.hashes[locn]);
+	    sp->old.dist[locn] = EMPTY;
+	    sp->remaining --;
+	}
+
+	if (++ sp->moved == sp->old.length || sp->remaining == 0) {
+	    destroyTable(&sp->old);
+	    break;
+	}
+
+	locn = (sp->start + sp->moved) % sp->old.length;
+
+	if (-- steps <= 0 && sp->old.dist[locn] <= 0)
+	    break;
+    }
+}
+
+
+/*
+ * Function:    resize
+ *
+ * Complexity:  O(m)
+ *
+ * Description: Start rehashing the set pointed to by SP into a new table
+ *		with LENGTH slots.  If a previous rehash is still in
+ *		progress, it is finished first.  Draining starts at the
+ *		first slot that begins a run, which exists since the table
+ *		is never full.
+ */
+
+static void resize(SET *sp, int length)
+{
+    drain(sp, INT_MAX);
+
+    sp->old = sp->cur;
+    sp->start = 0;
+    sp->moved = 0;
+    sp->remaining = sp->count;
+
+    createTable(&sp->cur, length);
+
+    if (sp->remaining == 0)
+	destroyTable(&sp->old);
+    else
+	while (sp->old.dist[sp->start] > 0)
+	    sp->start ++;
+}
+
+
+/*
+ * Function:    createSet
+ *
+ * Complexity:  O(m)
+ *
+ * Description: Return a pointer to a new set with an initial capacity of
+ *		MAXELTS.  The set grows as needed.
+ */
+
+SET *createSet(int maxElts, int (*compare)(), unsigned (*hash)())
+{
+    SET *sp;
+
+
+    assert(compare != NULL && hash != NULL && maxElts > 0);
+
+    sp = malloc(sizeof(SET));
+    assert(sp != NULL);
+
+    sp->compare = compare;
+    sp->hash = hash;
+    sp->count = 0;
+    sp->minLength = maxElts;
+    sp->start = 0;
+    sp->moved = 0;
+    sp->remaining = 0;
+
+    createTable(&sp->cur, maxElts);
+
+    sp->old.data = NULL;
+    sp->old.hashes = NULL;
+    sp->old.dist = NULL;
+    sp->old.length = 0;
+
+    return sp;
+}
+
+
+/*
+ * Function:    destroySet
+ *
+ * Complexity:  O(1)
+ *
+ * Description: Deallocate memory associated with the set pointed to by SP.
+ *		The elements themselves are not deallocated since we did not
+ *		allocate them in the first place.
+ */
+
+void destroySet(SET *sp)
+{
+    assert(sp != NULL);
+
+    destroyTable(&sp->old);
+    destroyTable(&sp->cur);
+    free(sp);
+}
+
+
+/*
+ * Function:    numElements
+ *
+ * Complexity:  O(1)
+ *
+ * Description: Return the number of elements in the set pointed to by SP.
+ */
+
+int numElements(SET *sp)
+{
+    assert(sp != NULL);
+    return sp->count;
+}
+
+
+/*
+ * Function:    add
+ *
+ * Complexity:  O(1) average case, O(n) worst case
+ *
+ * Description: Add ELT, whose hash value is HASH, to the set pointed to by
+ *		SP, and return the element in the set equal to it, which is
+ *		ELT itself unless one was already present.  If the set would
+ *		then fill more than three-quarters of the current table, a
+ *		rehash into a table twice as large is started first.
+ */
+
+static void *add(SET *sp, void *elt, unsigned hash)
+{
+    int locn, length;
+
+
+    if ((locn = search(sp, &sp->cur, elt, hash)) != -1)
+	return sp->cur.data[locn];
+
+    if (sp->old.data != NULL && !drained(sp, hash) &&
+	    (locn = search(sp, &sp->old, elt, hash)) != -1)
+	return sp->old.data[locn];
+
+    length = sp->cur.length;
+
+    if ((long) (sp->count + 1) * 4 > (long) length * 3) {
+	assert(length <= INT_MAX / 2);
+	resize(sp, length * 2);
+    }
+
+    insert(&sp->cur, elt, hash);
+    sp->count ++;
+    return elt;
+}
+
+
+/*
+ * Function:    addElement
+ *
+ * Complexity:  O(1) average case, O(n) worst case
+ *
+ * Description: Add ELT to the set pointed to by SP.
+ */
+
+void addElement(SET *sp, void *elt)
+{
+    assert(sp != NULL && elt != NULL);
+
+    drain(sp, STEPS);
+    add(sp, elt, (*sp->hash)(elt));
+}
+
+
+/*
+ * Function:    removeElement
+ *
+ * Complexity:  O(1) average case, O(n) worst case
+ *
+ * Description: Remove ELT from the set pointed to by SP.  If fewer than
+ *		one-eighth of the slots then hold elements, a rehash into a
+ *		table half as large is started, but never below the initial
+ *		size of the set.
+ */
+
+void removeElement(SET *sp, void *elt)
+{
+    int locn;
+    unsigned hash;
+
+
+    assert(sp != NULL && elt != NULL);
+
+    drain(sp, STEPS);
+    hash = (*sp->hash)(elt);
+
+    if ((locn = search(sp, &sp->cur, elt, hash)) != -1)
+	delete(&sp->cur, locn);
+
+    else if (sp->old.data != NULL && !drained(sp, hash) &&
+	    (locn = search(sp, &sp->old, elt, hash)) != -1) {
+	delete(&sp->old, locn);
+
+	if (-- sp->remaining == 0)
+	    destroyTable(&sp->old);
+
+    } else
+	return;
+
+    sp->count --;
+
+    if ((long) sp->count * 8 < sp->cur.length &&
+	    sp->cur.length / 2 >= sp->minLength)
+	resize(sp, sp->cur.length / 2);
+}
+
+
+/*
+ * Function:    find
+ *
+ * Complexity:  O(1) average case, O(n) worst case
+ *
+ * Description: If ELT, whose hash value is HASH, is present in the set
+ *		pointed to by SP then return it, otherwise return NULL.
+ */
+
+static void *find(SET *sp, void *elt, unsigned hash)
+{
+    int locn;
+
+
+    if ((locn = search(sp, &sp->cur, elt, hash)) != -1)
+	return sp->cur.data[locn];
+
+    if (sp->old.data != NULL && !drained(sp, hash) &&
+	    (locn = search(sp, &sp->old, elt, hash)) != -1)
+	return sp->old.data[locn];
+
+    return NULL;
+}
+
+
+/*
+ * Function:    findElement
+ *
+ * Complexity:  O(1) average case, O(n) worst case
+ *
+ * Description: If ELT is present in the set pointed to by SP then return
+ *		it, otherwise return NULL.
+ */
+
+void *findElement(SET *sp, void *elt)
+{
+    assert(sp != NULL && elt != NULL);
+
+    drain(sp, STEPS);
+    return find(sp, elt, (*sp->hash)(elt));
+}
+
+
+/*
+ * Function:    prefetch
+ *
+ * Complexity:  O(1)
+ *
+ * Description: Hash each of the N elements ELTS into HASHES and ask the
+ *		processor to start loading the home slot of each from the
+ *		current table of the set pointed to by SP, and from the old
+ *		table if it may still be there, so that the slots are in the
+ *		cache by the time they are searched.
+ */
+
+static void prefetch(SET *sp, void **elts, unsigned *hashes, int n)
+{
+    int i, locn;
+
+
+    for (i = 0; i < n; i ++) {
+	hashes[i] = (*sp->hash)(elts[i]);
+	locn = hashes[i] % sp->cur.length;
+	__builtin_prefetch(&sp->cur.dist[locn]);
+	__builtin_prefetch(&sp->cur.hashes[locn]);
+	__builtin_prefetch(&sp->cur.data[locn]);
+
+	if (sp->old.data != NULL && !drained(sp, hashes[i])) {
+	    locn = hashes[i] % sp->old.length;
+	    __builtin_prefetch(&sp->old.dist[locn]);
+	    __builtin_prefetch(&sp->old.hashes[locn]);
+	}
+    }
+}
+
+
+/*
+ * Function:    findElements
+ *
+ * Complexity:  O(n) average case, O(n^2) worst case
+ *
+ * Description: Search the set pointed to by SP for each of the N elements
+ *		ELTS, setting the corresponding entry of OUT as findElement
+ *		would return it.  The elements are handled BATCH at a time:
+ *		all of a batch are hashed and their slots prefetched before
+ *		any is searched, so the cache misses overlap.
+ */
+
+void findElements(SET *sp, void **elts, void **out, int n)
+{
+    unsigned hashes[BATCH];
+    int i, j, count;
+
+
+    assert(sp != NULL && ((elts != NULL && out != NULL) || n == 0));
+
+    for (i = 0; i < n; i += BATCH) {
+	count = n - i < BATCH ? n - i : BATCH;
+	drain(sp, STEPS);
+	prefetch(sp, elts + i, hashes, count);
+
+	for (j = 0; j < count; j ++)
+	    out[i + j] = find(sp, elts[i + j], hashes[j]);
+    }
+}
+
+
+/*
+ * Function:    addElements
+ *
+ * Complexity:  O(n) average case, O(n^2) worst case
+ *
+ * Description: Add each of the N elements ELTS to the set pointed to by
+ *		SP, setting the corresponding entry of OUT to the element in
+ *		the set equal to it: either the element itself, or one that
+ *		was already present, possibly from earlier in ELTS.  The
+ *		elements are prefetched BATCH at a time as in findElements.
+ */
+
+void addElements(SET *sp, void **elts, void **out, int n)
+{
+    unsigned hashes[BATCH];
+    int i, j, count;
+
+
+    assert(sp != NULL && ((elts != NULL && out != NULL) || n == 0));
+
+    for (i = 0; i < n; i += BATCH) {
+	count = n - i < BATCH ? n - i : BATCH;
+	prefetch(sp, elts + i, hashes, count);
+
+	for (j = 0; j < count; j ++) {
+	    drain(sp, STEPS);
+	    out[i + j] = add(sp, elts[i + j], hashes[j]);
+	}
+    }
+}
+
+/*
+ * Function:	getElements
+ *
+ * Complexity:	O(m)
+ *
+ * Description:	Allocate and return an array of elements in the set pointed
+ *		to by SP.
+ */
+void *getElements(SET *sp)
+{
+	assert(sp != NULL);
+	void** elements = malloc(sizeof(void*)*sp->count);
+	assert(elements != NULL);
+	int i;
+	int j;
+	for(i = 0, j = 0; i < sp->cur.length; i++)
+	{
+		if(sp->cur.dist[i] != EMPTY)
+		{
+			elements[j++] = sp->cur.data[i];
+		}
+	}
+	for(i = 0; i < sp->old.length; i++)
+	{
+		if(sp->old.dist[i] != EMPTY)
+		{
+			elements[j++] = sp->old.data[i];
+		}
+	}
+	sortElements(elements, sp->count, sp->compare);
+	return elements;
+}
+
+/*
+ * Function:	visitElements
+ *
+ * Complexity:	O(m)
+ *
+ * Description:	Call VISIT(elt, ARG) on each element in the set pointed to
+ *		by SP, in no particular order.  The slots are walked in
+ *		place, so unlike getElements nothing is allocated, copied,
+ *		or sorted.
+ */
+void visitElements(SET *sp, void (*visit)(), void *arg)
+{
+	assert(sp != NULL && visit != NULL);
+	int i;
+	for(i = 0; i < sp->cur.length; i++)
+	{
+		if(sp->cur.dist[i] != EMPTY)
+		{
+			(*visit)(sp->cur.data[i], arg);
+		}
+	}
+	for(i = 0; i < sp->old.length; i++)
+	{
+		if(sp->old.dist[i] != EMPTY)
+		{
+			(*visit)(sp->old.data[i], arg);
+		}
+	}
+}
+
+
+/*
+ * Function:    probeLengths
+ *
+ * Complexity:  O(m) average case
+ *
+ * Description: Fill in HITS and MISSES, each with N entries, with the
+ *		distribution of probe lengths in the set pointed to by SP.
+ *		HITS[i] is the number of elements whose successful search
+ *		examines i + 1 slots.  MISSES[i] is the number of slots at
+ *		which an unsuccessful search starting there examines i + 1
+ *		slots.  Longer probes are counted in the last entry.
+ */
+
+void probeLengths(SET *sp, long hits[], long misses[], int n)
+{
+    int d, i, j, locn;
+    TABLE *tp;
+
+
+    assert(sp != NULL && n > 0);
+
+    for (i = 0; i < n; i ++)
+	hits[i] = misses[i] = 0;
+
+    for (tp = &sp->cur; tp != NULL; tp = (tp == &sp->cur ? &sp->old : NULL))
+	for (i = 0; i < tp->length; i ++) {
+	    if (tp->dist[i] != EMPTY)
+		hits[tp->dist[i] < n ? tp->dist[i] : n - 1] ++;
+
+	    for (d = 0, locn = i; tp->dist[locn] >= d; d ++)
+		if (++ locn == tp->length)
+		    locn = 0;
+
+	    j = d < n ? d : n - 1;
+	    misses[j] ++;
+	}
+}
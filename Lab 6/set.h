@@ -26,6 +26,12 @@ void removeElement(SET *sp, void *elt);
 
 void *findElement(SET *sp, void *elt);
 
+void findElements(SET *sp, void **elts, void **out, int n);
+
+void addElements(SET *sp, void **elts, void **out, int n);
+
 void *getElements(SET *sp);
 
+void visitElements(SET *sp, void (*visit)(), void *arg);
+
 # endif /* SET_H */
@@ -0,0 +1,395 @@
+/*
+ * File:        sort.c
+ *
+ * Description: This file contains the definitions of functions for
+ *              sorting an array of generic pointers with a comparison
+ *              function.
+ *
+ *              The sort is an introsort: a quicksort with the median of
+ *              the first, middle, and last elements as its pivot, which
+ *              switches to heapsort if the recursion becomes deeper than
+ *              twice the logarithm of the number of elements, and leaves
+ *              small subarrays to a final insertion sort.  It therefore
+ *              takes O(n log n) time on any input, including sorted input
+ *              and input with many equal elements, and recurses only on
+ *              the smaller side of each partition, so the stack depth is
+ *              O(log n).
+ *
+ *              An array of at least the threshold given to configureSort
+ *              is divided among several threads, each of which sorts its
+ *              part, and the parts are then merged pairwise, with the
+ *              merges of each round also done in parallel.
+ */
+
+# include <stdlib.h>
+# include <string.h>
+# include <unistd.h>
+# include <pthread.h>
+# include <assert.h>
+# include "sort.h"
+
+# define CUTOFF	 16		/* largest subarray left unsorted */
+
+static int threads = 0;		/* zero means the number of processors */
+static int threshold = 1 << 16;	/* smallest array sorted in parallel  */
+
+struct job {
+    void **elts;		/* array to sort or merge into */
+    void **src;			/* source of a merge           */
+    int n;			/* length of first part        */
+    int m;			/* length of second part       */
+    int (*compare)();		/* comparison function         */
+};
+
+
+/*
+ * Function:    configureSort
+ *
+ * Complexity:  O(1)
+ *
+ * Description: Sort arrays of at least THRESHOLD elements with up to
+ *		THREADS threads.  A THREADS of zero means one per processor,
+ *		and a THREADS of one never sorts in parallel.
+ */
+
+void configureSort(int nthreads, int nthreshold)
+{
+    assert(nthreads >= 0 && nthreshold >= 0);
+
+    threads = nthreads;
+    threshold = nthreshold;
+}
+
+
+/*
+ * Function:    siftDown
+ *
+ * Complexity:  O(log n)
+ *
+ * Description: Restore the heap property of the N elements ELTS, which
+ *		form a max-heap except perhaps at index I.
+ */
+
+static void siftDown(void **elts, int i, int n, int (*compare)())
+{
+    void *elt;
+    int child;
+
+
+    elt = elts[i];
+
+    while ((child = 2 * i + 1) < n) {
+	if (child + 1 < n && (*compare)(elts[child + 1], elts[child]) > 0)
+	    child ++;
+
+	if ((*compare)(elts[child], elt) <= 0)
+	    break;
+
+	elts[i] = elts[child];
+	i = child;
+    }
+
+    elts[i] = elt;
+}
+
+
+/*
+ * Function:    heapsort
+ *
+ * Complexity:  O(n log n)
+ *
+ * Description: Sort the N elements ELTS using a binary heap.
+ */
+
+static void heapsort(void **elts, int n, int (*compare)())
+{
+    void *elt;
+    int i;
+
+
+    for (i = n / 2 - 1; i >= 0; i --)
+	siftDown(elts, i, n, compare);
+
+    for (i = n - 1; i > 0; i --) {
+	elt = elts[0];
+	elts[0] = elts[i];
+	elts[i] = elt;
+	siftDown(elts, 0, i, compare);
+    }
+}
+
+
+/*
+ * Function:    insertionSort
+ *
+ * Complexity:  O(n^2) worst case, O(n) if nearly sorted
+ *
+ * Description: Sort the N elements ELTS by insertion.  After the
+ *		introsort each element is within CUTOFF of its place, so this
+ *		takes linear time.
+ */
+
+static void insertionSort(void **elts, int n, int (*compare)())
+{
+    void *elt;
+    int i, j;
+
+
+    for (i = 1; i < n; i ++) {
+	elt = elts[i];
+
+	for (j = i; j > 0 && (*compare)(elts[j - 1], elt) > 0; j --)
+	    elts[j] = elts[j - 1];
+
+	elts[j] = elt;
+    }
+}
+
+
+/*
+ * Function:    median
+ *
+ * Complexity:  O(1)
+ *
+ * Description: Return whichever of A, B, and C is between the other two.
+ */
+
+static void *median(void *a, void *b, void *c, int (*compare)())
+{
+    if ((*compare)(a, b) < 0) {
+	if ((*compare)(b, c) < 0)
+	    return b;
+
+	return (*compare)(a, c) < 0 ? c : a;
+    }
+
+    if ((*compare)(a, c) < 0)
+	return a;
+
+    return (*compare)(b, c) < 0 ? c : b;
+}
+
+
+/*
+ * Function:    introsort
+ *
+ * Complexity:  O(n log n)
+ *
+ * Description: Partially sort the N elements ELTS, leaving subarrays of at
+ *		most CUTOFF elements unsorted, with at most DEPTH levels of
+ *		partitioning before switching to heapsort.  The partition
+ *		stops on elements equal to the pivot from both sides, so
+ *		many equal elements split evenly rather than all to one side.
+ */
+
+static void introsort(void **elts, int n, int depth, int (*compare)())
+{
+    void *pivot, *elt;
+    int i, j;
+
+
+    while (n > CUTOFF) {
+	if (depth -- == 0) {
+	    heapsort(elts, n, compare);
+	    return;
+	}
+
+	pivot = median(elts[0], elts[n / 2], elts[n - 1], compare);
+	i = -1;
+	j = n;
+
+	while (1) {
+	    while ((*compare)(elts[++ i], pivot) < 0)
+		;
+
+	    while ((*compare)(elts[-- j], pivot) > 0)
+		;
+
+	    if (i >= j)
+		break;
+
+	    elt = elts[i];
+	    elts[i] = elts[j];
+	    elts[j] = elt;
+	}
+
+	if (j + 1 < n - j - 1) {
+	    introsort(elts, j + 1, depth, compare);
+	    elts += j + 1;
+	    n -= j + 1;
+	} else {
+	    introsort(elts + j + 1, n - j - 1, depth, compare);
+	    n = j + 1;
+	}
+    }
+}
+
+
+/*
+ * Function:    serialSort
+ *
+ * Complexity:  O(n log n)
+ *
+ * Description: Sort the N elements ELTS in the calling thread.
+ */
+
+static void serialSort(void **elts, int n, int (*compare)())
+{
+    int depth;
+
+
+    for (depth = 0; (1 << depth) < n; depth ++)
+	;
+
+    introsort(elts, n, 2 * depth, compare);
+    insertionSort(elts, n, compare);
+}
+
+
+/*
+ * Function:    sortJob
+ *
+ * Description: Sort the part of the array described by the job pointed to
+ *		by ARG.
+ */
+
+static void *sortJob(void *arg)
+{
+    struct job *jp = arg;
+
+
+    serialSort(jp->elts, jp->n, jp->compare);
+    return NULL;
+}
+
+
+/*
+ * Function:    mergeJob
+ *
+ * Description: Merge the two sorted parts of the source array described by
+ *		the job pointed to by ARG into its destination.
+ */
+
+static void *mergeJob(void *arg)
+{
+    struct job *jp = arg;
+    void **a, **b, **out;
+    int i, j;
+
+
+    a = jp->src;
+    b = jp->src + jp->n;
+    out = jp->elts;
+
+    for (i = j = 0; i < jp->n && j < jp->m; )
+	if ((*jp->compare)(b[j], a[i]) < 0)
+	    *out ++ = b[j ++];
+	else
+	    *out ++ = a[i ++];
+
+    memcpy(out, a + i, sizeof(void *) * (jp->n - i));
+    memcpy(out + jp->n - i, b + j, sizeof(void *) * (jp->m - j));
+    return NULL;
+}
+
+
+/*
+ * Function:    run
+ *
+ * Description: Run FUNC on each of the N jobs JOBS, each in its own thread
+ *		except the last, which runs in the calling thread.  A job
+ *		for which no thread can be created also runs in the calling
+ *		thread.
+ */
+
+static void run(void *(*func)(void *), struct job *jobs, int n)
+{
+    pthread_t *tids;
+    char *started;
+    int i;
+
+
+    tids = malloc(sizeof(pthread_t) * n);
+    started = malloc(sizeof(char) * n);
+    assert(tids != NULL && started != NULL);
+
+    for (i = 0; i < n - 1; i ++)
+	if (!(started[i] = pthread_create(&tids[i], NULL, func, &jobs[i]) == 0))
+	    (*func)(&jobs[i]);
+
+    (*func)(&jobs[n - 1]);
+
+    for (i = 0; i < n - 1; i ++)
+	if (started[i])
+	    pthread_join(tids[i], NULL);
+
+    free(started);
+    free(tids);
+}
+
+
+/*
+ * Function:    sortElements
+ *
+ * Complexity:  O(n log n)
+ *
+ * Description: Sort the N elements ELTS into ascending order according to
+ *		COMPARE, in parallel if there are enough of them.  The parts
+ *		sorted by each thread begin at multiples of the part size,
+ *		and each round of merging doubles the part size.
+ */
+
+void sortElements(void **elts, int n, int (*compare)())
+{
+    void **src, **dst, **tmp;
+    struct job *jobs;
+    int i, k, size, nthreads;
+
+
+    assert((elts != NULL || n == 0) && compare != NULL);
+
+    nthreads = threads > 0 ? threads : sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (nthreads < 2 || n < threshold || n < 2 * nthreads) {
+	serialSort(elts, n, compare);
+	return;
+    }
+
+    jobs = malloc(sizeof(struct job) * nthreads);
+    tmp = malloc(sizeof(void *) * n);
+    assert(jobs != NULL && tmp != NULL);
+
+    size = (n + nthreads - 1) / nthreads;
+
+    for (i = k = 0; i < n; i += size, k ++) {
+	jobs[k].elts = elts + i;
+	jobs[k].n = n - i < size ? n - i : size;
+	jobs[k].compare = compare;
+    }
+
+    run(sortJob, jobs, k);
+
+    src = elts;
+    dst = tmp;
+
+    for (; size < n; size *= 2) {
+	for (i = k = 0; i < n; i += 2 * size, k ++) {
+	    jobs[k].src = src + i;
+	    jobs[k].elts = dst + i;
+	    jobs[k].n = n - i < size ? n - i : size;
+	    jobs[k].m = n - i - jobs[k].n < size ? n - i - jobs[k].n : size;
+	    jobs[k].compare = compare;
+	}
+
+	run(mergeJob, jobs, k);
+
+	src = dst;
+	dst = dst == tmp ? elts : tmp;
+    }
+
+    if (src != elts)
+	memcpy(elts, src, sizeof(void *) * n);
+
+    free(tmp);
+    free(jobs);
+}
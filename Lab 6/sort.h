@@ -0,0 +1,16 @@
+/*
+ * File:        sort.h
+ *
+ * Description: This file contains the public function declarations for
+ *              sorting an array of generic pointers with a comparison
+ *              function, as getElements does for each set.
+ */
+
+# ifndef SORT_H
+# define SORT_H
+
+void sortElements(void **elts, int n, int (*compare)());
+
+void configureSort(int threads, int threshold);
+
+# endif /* SORT_H */
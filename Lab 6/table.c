@@ -12,64 +12,147 @@
  *
  *              This implementation uses a hash table to store the
  *              elements, with linear probing to resolve collisions.
- *              Insertion, deletion, and membership chec
+ *              Insertion, deletion, and membership checks are all average
+ *              case constant time.
+ *
+ *              The table grows when too many of its slots are in use and
+ *              shrinks after mass deletions, so the maximum given to
+ *              createSet is only the initial (and minimum) size.  Rather
+ *              than copying everything at once, a resize keeps the old
+ *              table around and every operation drains a bounded number
+ *              of its slots into the new one, so no single call ever pays
+ *              for the whole rehash.
+ *
+ *              The hash value of each element is kept alongside it, so
+ *              the comparison function is only called when the hash values
+ *              match, and a rehash never needs to call the hash function.
  */
 # include <stdio.h>
 # include <stdlib.h>
 # include <string.h>
 # include <assert.h>
 # include <stdbool.h>
+# include <limits.h>
 # include "set.h"
+# include "probe.h"
+# include "sort.h"
 
 # define EMPTY   0
 # define FILLED  1
 # define DELETED 2
 
-struct set {
-    int count;                  /* number of elements in array */
-    int length;                 /* length of allocated array   */
+# define STEPS	 16		/* old slots drained per operation */
+# define BATCH	 16		/* elements prefetched at once     */
+
+typedef struct table {
+    int length;                 /* length of allocated arrays  */
     void **data;                /* array of allocated elements */
+    unsigned *hashes;           /* hash value of each element  */
     char *flags;                /* state of each slot in array */
+} TABLE;
+
+struct set {
+    int count;                  /* number of elements in set   */
+    int deleted;                /* deleted slots in cur table  */
+    int minLength;              /* never shrink below this     */
+    int moved;                  /* old slots drained so far    */
+    int remaining;              /* elements left in old table  */
+    TABLE cur;                  /* table receiving insertions  */
+    TABLE old;                  /* table being drained, if any */
     int (*compare)();		/* comparison function         */
     unsigned (*hash)();		/* hash function               */
 };
 
 
+/*
+ * Function:    createTable
+ *
+ * Complexity:  O(m)
+ *
+ * Description: Allocate the arrays for the table pointed to by TP with
+ *		LENGTH slots, all of which are empty.
+ */
+
+static void createTable(TABLE *tp, int length)
+{
+    int i;
+
+
+    tp->data = malloc(sizeof(void *) * length);
+    assert(tp->data != NULL);
+
+    tp->hashes = malloc(sizeof(unsigned) * length);
+    assert(tp->hashes != NULL);
+
+    tp->flags = malloc(sizeof(char) * length);
+    assert(tp->flags != NULL);
+
+    tp->length = length;
+
+    for (i = 0; i < length; i ++)
+	tp->flags[i] = EMPTY;
+}
+
+
+/*
+ * Function:    destroyTable
+ *
+ * Complexity:  O(1)
+ *
+ * Description: Deallocate the arrays for the table pointed to by TP.
+ */
+
+static void destroyTable(TABLE *tp)
+{
+    free(tp->flags);
+    free(tp->hashes);
+    free(tp->data);
+
+    tp->data = NULL;
+    tp->hashes = NULL;
+    tp->flags = NULL;
+    tp->length = 0;
+}
+
+
 /*
  * Function:    search
  *
  * Complexity:  O(1) average case, O(n) worst case
  *
- * Description: Return the location of ELT in the set pointed to by SP.  If
- *		the element is present, then *FOUND is true.  If not
+ * Description: Return the location of ELT in the table pointed to by TP.
+ *		If the element is present, then *FOUND is true.  If not
  *		present, then *FOUND is false.  The element is first hashed
- *		to its correct location.  Linear probing is used to examine
- *		subsequent locations.
+ *		to its correct location using its hash value HASH.  Linear
+ *		probing is used to examine subsequent locations.  Elements
+ *		are only compared if their hash values are equal.
  */
 
-static int search(SET *sp, void *elt, bool *found)
+static int search(SET *sp, TABLE *tp, void *elt, unsigned hash, bool *found)
 {
-    int available, i, locn, start;
+    int available, i, locn;
 
 
     available = -1;
-    start = (*sp->hash)(elt) % sp->length;
+    locn = hash % tp->length;
 
-    for (i = 0; i < sp->length; i ++) {
-        locn = (start + i) % sp->length;
+    for (i = 0; i < tp->length; i ++) {
+	if (tp->flags[locn] == EMPTY) {
+	    *found = false;
+	    return available != -1 ? available : locn;
 
-        if (sp->flags[locn] == EMPTY) {
-            *found = false;
-            return available != -1 ? available : locn;
-
-        } else if (sp->flags[locn] == DELETED) {
-            if (available == -1)
+	} else if (tp->flags[locn] == DELETED) {
+	    if (available == -1)
 		available = locn;
 
-        } else if ((*sp->compare)(sp->data[locn], elt) == 0) {
-            *found = true;
-            return locn;
-        }
+	} else if (tp->hashes[locn] == hash &&
+		(*sp->compare)(tp->data[locn], elt) == 0) {
+	    *found = true;
+	    return locn;
+	}
+
+	if (++ locn == tp->length)
+	    locn = 0;
     }
 
     *found = false;
@@ -77,39 +160,132 @@ static int search(SET *sp, void *elt, bool *found)
 }
 
 
+/*
+ * Function:    vacancy
+ *
+ * Complexity:  O(1) average case, O(n) worst case
+ *
+ * Description: Return the first location that is not filled in the probe
+ *		sequence for hash value HASH in the table pointed to by TP.
+ *		The caller must know that the element is not already
+ *		present, so no comparisons are needed.
+ */
+
+static int vacancy(TABLE *tp, unsigned hash)
+{
+    int locn;
+
+
+    locn = hash % tp->length;
+
+    while (tp->flags[locn] == FILLED)
+	if (++ locn == tp->length)
+	    locn = 0;
+
+    return locn;
+}
+
+
+/*
+ * Function:    drain
+ *
+ * Complexity:  O(1)
+ *
+ * Description: Move the elements in up to STEPS slots of the old table of
+ *		the set pointed to by SP into the current table.  Once the
+ *		whole old table has been drained it is deallocated.  A
+ *		moved slot is marked as deleted so that searches of the old
+ *		table still probe past it.  The hash values of the elements
+ *		are already known, so the hash function is never called.
+ */
+
+static void drain(SET *sp, int steps)
+{
+    int locn;
+
+
+    while (sp->old.data != NULL && steps -- > 0) {
+	if (sp->old.flags[sp->moved] == FILLED) {
+	    locn = vacancy(&sp->cur, sp->old.hashes[sp->moved]);
+
+	    if (sp->cur.flags[locn] == DELETED)
+		sp->deleted --;
+
+	    sp->cur.data[locn] = sp->old.data[sp->moved];
+	    sp->cur.hashes[locn] = sp->old.hashes[sp->moved];
+	    sp->cur.flags[locn] = FILLED;
+	    sp->old.flags[sp->moved] = DELETED;
+	    sp->remaining --;
+	}
+
+	if (++ sp->moved == sp->old.length || sp->remaining == 0)
+	    destroyTable(&sp->old);
+    }
+}
+
+
+/*
+ * Function:    resize
+ *
+ * Complexity:  O(m)
+ *
+ * Description: Start rehashing the set pointed to by SP into a new table
+ *		with LENGTH slots.  Only the allocation is done here; the
+ *		elements are moved a few at a time by drain.  If a previous
+ *		rehash is still in progress, it is finished first.  That
+ *		cannot happen unless the table is resized again before
+ *		O(m) operations have been performed since the last time.
+ */
+
+static void resize(SET *sp, int length)
+{
+    drain(sp, INT_MAX);
+
+    sp->old = sp->cur;
+    sp->moved = 0;
+    sp->remaining = sp->count;
+    sp->deleted = 0;
+
+    createTable(&sp->cur, length);
+
+    if (sp->remaining == 0)
+	destroyTable(&sp->old);
+}
+
+
 /*
  * Function:    createSet
  *
  * Complexity:  O(m)
  *
- * Description: Return a pointer to a new set with a maximum capacity of
- *		MAXELTS.
+ * Description: Return a pointer to a new set with an initial capacity of
+ *		MAXELTS.  The set grows as needed.
  */
 
 SET *createSet(int maxElts, int (*compare)(), unsigned (*hash)())
 {
-    int i;
     SET *sp;
 
 
-    assert(compare != NULL && hash != NULL);
+    assert(compare != NULL && hash != NULL && maxElts > 0);
 
     sp = malloc(sizeof(SET));
     assert(sp != NULL);
 
-    sp->data = malloc(sizeof(char *) * maxElts);
-    assert(sp->data != NULL);
-
-    sp->flags = malloc(sizeof(char) * maxElts);
-    assert(sp->flags != NULL);
-
     sp->compare = compare;
     sp->hash = hash;
-    sp->length = maxElts;
     sp->count = 0;
+    sp->deleted = 0;
+    sp->minLength = maxElts;
+    sp->moved = 0;
+    sp->remaining = 0;
+
+    createTable(&sp->cur, maxElts);
 
-    for (i = 0; i < maxElts; i ++)
-        sp->flags[i] = EMPTY;
+    sp->old.data = NULL;
+    sp->old.hashes = NULL;
+    sp->old.flags = NULL;
+    sp->old.length = 0;
 
     return sp;
 }
@@ -118,7 +294,7 @@ SET *createSet(int maxElts, int (*compare)(), unsigned (*hash)())
 /*
  * Function:    destroySet
  *
- * Complexity:  O(m)
+ * Complexity:  O(1)
  *
  * Description: Deallocate memory associated with the set pointed to by SP.
  *		The elements themselves are not deallocated since we did not
@@ -130,8 +306,8 @@ void destroySet(SET *sp)
 {
     assert(sp != NULL);
 
-    free(sp->flags);
-    free(sp->data);
+    destroyTable(&sp->old);
+    destroyTable(&sp->cur);
     free(sp);
 }
 
@@ -152,29 +328,76 @@ int numElements(SET *sp)
 
 
 /*
- * Function:    addElement
+ * Function:    add
  *
  * Complexity:  O(1) average case, O(n) worst case
  *
- * Description: Add ELT to the set pointed to by SP.
+ * Description: Add ELT, whose hash value is HASH, to the set pointed to by
+ *		SP, and return the element in the set equal to it, which is
+ *		ELT itself unless one was already present.  If the current
+ *		table would become more than three-quarters used (counting
+ *		deleted slots, which lengthen probes just as filled ones
+ *		do), then a rehash is started first: into a table twice as
+ *		large if at least half the slots hold elements, or into one
+ *		of the same size to clear out the deleted slots otherwise.
  */
 
-void addElement(SET *sp, void *elt)
+static void *add(SET *sp, void *elt, unsigned hash)
 {
-    int locn;
+    int locn, oldLocn, length;
     bool found;
 
 
-    assert(sp != NULL && elt != NULL);
-    locn = search(sp, elt, &found);
+    locn = search(sp, &sp->cur, elt, hash, &found);
 
-    if (!found) {
-	assert(sp->count < sp->length);
+    if (found)
+	return sp->cur.data[locn];
 
-	sp->data[locn] = elt;
-	sp->flags[locn] = FILLED;
-	sp->count ++;
+    if (sp->old.data != NULL) {
+	oldLocn = search(sp, &sp->old, elt, hash, &found);
+
+	if (found)
+	    return sp->old.data[oldLocn];
     }
+
+    length = sp->cur.length;
+
+    if ((long) (sp->count - sp->remaining + sp->deleted + 1) * 4 >
+	    (long) length * 3) {
+	if ((long) sp->count * 2 >= length) {
+	    assert(length <= INT_MAX / 2);
+	    length *= 2;
+	}
+
+	resize(sp, length);
+	locn = vacancy(&sp->cur, hash);
+    }
+
+    if (sp->cur.flags[locn] == DELETED)
+	sp->deleted --;
+
+    sp->cur.data[locn] = elt;
+    sp->cur.hashes[locn] = hash;
+    sp->cur.flags[locn] = FILLED;
+    sp->count ++;
+    return elt;
+}
+
+
+/*
+ * Function:    addElement
+ *
+ * Complexity:  O(1) average case, O(n) worst case
+ *
+ * Description: Add ELT to the set pointed to by SP.
+ */
+
+void addElement(SET *sp, void *elt)
+{
+    assert(sp != NULL && elt != NULL);
+
+    drain(sp, STEPS);
+    add(sp, elt, (*sp->hash)(elt));
 }
 
 
@@ -184,78 +407,190 @@ void addElement(SET *sp, void *elt)
  * Complexity:  O(1) average case, O(n) worst case
  *
  * Description: Remove ELT from the set pointed to by SP.  A element is
- *		deleted by changing the state of its slot.
+ *		deleted by changing the state of its slot.  If fewer than
+ *		one-eighth of the slots then hold elements, a rehash into a
+ *		table half as large is started, but never below the initial
+ *		size of the set.
  */
 
 void removeElement(SET *sp, void *elt)
 {
     int locn;
+    unsigned hash;
     bool found;
 
 
     assert(sp != NULL && elt != NULL);
-    locn = search(sp, elt, &found);
+
+    drain(sp, STEPS);
+    hash = (*sp->hash)(elt);
+    locn = search(sp, &sp->cur, elt, hash, &found);
 
     if (found) {
-	sp->flags[locn] = DELETED;
+	sp->cur.flags[locn] = DELETED;
+	sp->deleted ++;
 	sp->count --;
+
+    } else if (sp->old.data != NULL) {
+	locn = search(sp, &sp->old, elt, hash, &found);
+
+	if (found) {
+	    sp->old.flags[locn] = DELETED;
+	    sp->remaining --;
+	    sp->count --;
+
+	    if (sp->remaining == 0)
+		destroyTable(&sp->old);
+	}
     }
+
+    if (found && (long) sp->count * 8 < sp->cur.length &&
+	    sp->cur.length / 2 >= sp->minLength)
+	resize(sp, sp->cur.length / 2);
 }
 
 
 /*
- * Function:    findElement
+ * Function:    find
  *
  * Complexity:  O(1) average case, O(n) worst case
  *
- * Description: If ELT is present in the set pointed to by SP then return
- *		it, otherwise return NULL.
+ * Description: If ELT, whose hash value is HASH, is present in the set
+ *		pointed to by SP then return it, otherwise return NULL.
  */
 
-void *findElement(SET *sp, void *elt)
+static void *find(SET *sp, void *elt, unsigned hash)
 {
     int locn;
     bool found;
 
 
+    locn = search(sp, &sp->cur, elt, hash, &found);
+
+    if (found)
+	return sp->cur.data[locn];
+
+    if (sp->old.data != NULL) {
+	locn = search(sp, &sp->old, elt, hash, &found);
+
+	if (found)
+	    return sp->old.data[locn];
+    }
+
+    return NULL;
+}
+
+
+/*
+ * Function:    findElement
+ *
+ * Complexity:  O(1) average case, O(n) worst case
+ *
+ * Description: If ELT is present in the set pointed to by SP then return
+ *		it, otherwise return NULL.
+ */
+
+void *findElement(SET *sp, void *elt)
+{
     assert(sp != NULL && elt != NULL);
 
-    locn = search(sp, elt, &found);
-    return found ? sp->data[locn] : NULL;
+    drain(sp, STEPS);
+    return find(sp, elt, (*sp->hash)(elt));
 }
 
-static int partition(SET* sp, void** elt, int low, int high)
+
+/*
+ * Function:    prefetch
+ *
+ * Complexity:  O(1)
+ *
+ * Description: Hash each of the N elements ELTS into HASHES and ask the
+ *		processor to start loading the home slot of each from both
+ *		tables of the set pointed to by SP, so that the slots are
+ *		in the cache by the time they are searched.
+ */
+
+static void prefetch(SET *sp, void **elts, unsigned *hashes, int n)
 {
-	assert(sp != NULL);
-	void* pivot = elt[high];
-	int smaller = low - 1;
-	int i;
-	for(i = low; i <= high - 1; i++)
-	{
-		if ((*sp->compare)(elt[i], pivot) <=0)
-		{
-			smaller++;
-			void* temp = elt[smaller];
-			elt[smaller] = elt[i];
-			elt[i] = temp;
-		}
+    int i, locn;
+
+
+    for (i = 0; i < n; i ++) {
+	hashes[i] = (*sp->hash)(elts[i]);
+	locn = hashes[i] % sp->cur.length;
+	__builtin_prefetch(&sp->cur.flags[locn]);
+	__builtin_prefetch(&sp->cur.hashes[locn]);
+	__builtin_prefetch(&sp->cur.data[locn]);
+
+	if (sp->old.data != NULL) {
+	    locn = hashes[i] % sp->old.length;
+	    __builtin_prefetch(&sp->old.flags[locn]);
+	    __builtin_prefetch(&sp->old.hashes[locn]);
 	}
-	void* swap = elt[smaller +1];
-	elt[smaller +1] = elt[high];
-	elt[high] = swap;
-	return smaller +1;
+    }
 }
 
-static void quicksort(SET* sp, void** elt, int low, int high)
+
+/*
+ * Function:    findElements
+ *
+ * Complexity:  O(n) average case, O(n^2) worst case
+ *
+ * Description: Search the set pointed to by SP for each of the N elements
+ *		ELTS, setting the corresponding entry of OUT as findElement
+ *		would return it.  The elements are handled BATCH at a time:
+ *		all of a batch are hashed and their slots prefetched before
+ *		any is searched, so the cache misses overlap.
+ */
+
+void findElements(SET *sp, void **elts, void **out, int n)
 {
-	assert(sp != NULL);
-	if(low < high)
-	{
-		int partitionIndex = partition(sp, elt, low, high);
-		quicksort(sp, elt, low, partitionIndex - 1);
-		quicksort(sp, elt, partitionIndex + 1, high);
+    unsigned hashes[BATCH];
+    int i, j, count;
+
+
+    assert(sp != NULL && ((elts != NULL && out != NULL) || n == 0));
+
+    for (i = 0; i < n; i += BATCH) {
+	count = n - i < BATCH ? n - i : BATCH;
+	drain(sp, STEPS);
+	prefetch(sp, elts + i, hashes, count);
+
+	for (j = 0; j < count; j ++)
+	    out[i + j] = find(sp, elts[i + j], hashes[j]);
+    }
+}
+
+
+/*
+ * Function:    addElements
+ *
+ * Complexity:  O(n) average case, O(n^2) worst case
+ *
+ * Description: Add each of the N elements ELTS to the set pointed to by
+ *		SP, setting the corresponding entry of OUT to the element in
+ *		the set equal to it: either the element itself, or one that
+ *		was already present, possibly from earlier in ELTS.  The
+ *		elements are prefetched BATCH at a time as in findElements.
+ */
+
+void addElements(SET *sp, void **elts, void **out, int n)
+{
+    unsigned hashes[BATCH];
+    int i, j, count;
+
+
+    assert(sp != NULL && ((elts != NULL && out != NULL) || n == 0));
+
+    for (i = 0; i < n; i += BATCH) {
+	count = n - i < BATCH ? n - i : BATCH;
+	prefetch(sp, elts + i, hashes, count);
+
+	for (j = 0; j < count; j ++) {
+	    drain(sp, STEPS);
+	    out[i + j] = add(sp, elts[i + j], hashes[j]);
 	}
-	return;
+    }
 }
 
 /*
@@ -273,13 +608,98 @@ void *getElements(SET *sp)
 	assert(elements != NULL);
 	int i;
 	int j;
-	for(i = 0, j = 0; i < sp->length; i++)
+	for(i = 0, j = 0; i < sp->cur.length; i++)
 	{
-		if(sp->flags[i] == FILLED)
+		if(sp->cur.flags[i] == FILLED)
 		{
-			elements[j++] = sp->data[i];
+			elements[j++] = sp->cur.data[i];
 		}
 	}
-	quicksort(sp, elements, 0, sp->count - 1);
+	for(i = 0; i < sp->old.length; i++)
+	{
+		if(sp->old.flags[i] == FILLED)
+		{
+			elements[j++] = sp->old.data[i];
+		}
+	}
+	sortElements(elements, sp->count, sp->compare);
 	return elements;
 }
+
+/*
+ * Function:	visitElements
+ *
+ * Complexity:	O(m)
+ *
+ * Description:	Call VISIT(elt, ARG) on each element in the set pointed to
+ *		by SP, in no particular order.  The slots are walked in
+ *		place, so unlike getElements nothing is allocated, copied,
+ *		or sorted.
+ */
+void visitElements(SET *sp, void (*visit)(), void *arg)
+{
+	assert(sp != NULL && visit != NULL);
+	int i;
+	for(i = 0; i < sp->cur.length; i++)
+	{
+		if(sp->cur.flags[i] == FILLED)
+		{
+			(*visit)(sp->cur.data[i], arg);
+		}
+	}
+	for(i = 0; i < sp->old.length; i++)
+	{
+		if(sp->old.flags[i] == FILLED)
+		{
+			(*visit)(sp->old.data[i], arg);
+		}
+	}
+}
+
+
+/*
+ * Function:    probeLengths
+ *
+ * Complexity:  O(m)
+ *
+ * Description: Fill in HITS and MISSES, each with N entries, with the
+ *		distribution of probe lengths in the set pointed to by SP.
+ *		HITS[i] is the number of elements whose successful search
+ *		examines i + 1 slots.  MISSES[i] is the number of slots at
+ *		which an unsuccessful search starting there examines i + 1
+ *		slots, which is one more than the number of slots up to the
+ *		next empty one.  We count those by walking backwards from
+ *		an empty slot.  Longer probes are counted in the last entry.
+ */
+
+void probeLengths(SET *sp, long hits[], long misses[], int n)
+{
+    int i, j, locn, run;
+    TABLE *tp;
+
+
+    assert(sp != NULL && n > 0);
+
+    for (i = 0; i < n; i ++)
+	hits[i] = misses[i] = 0;
+
+    for (tp = &sp->cur; tp != NULL; tp = (tp == &sp->cur ? &sp->old : NULL)) {
+	for (i = 0; i < tp->length; i ++)
+	    if (tp->flags[i] == FILLED) {
+		j = i - (int) (tp->hashes[i] % tp->length);
+		j = j < 0 ? j + tp->length : j;
+		hits[j < n ? j : n - 1] ++;
+	    }
+
+	for (locn = 0; locn < tp->length && tp->flags[locn] != EMPTY; locn ++)
+	    ;
+
+	for (i = run = 0; i < tp->length; i ++) {
+	    run = tp->flags[locn] == EMPTY ? 0 : run + 1;
+	    misses[run < n ? run : n - 1] ++;
+
+	    if (-- locn < 0)
+		locn = tp->length - 1;
+	}
+    }
+}
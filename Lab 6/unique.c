@@ -12,6 +12,12 @@
  *              total words in the set are printed.  If the second file is
  *              given then all words in the second file are deleted from
  *              the set and the count printed.
+ *
+ *              Words are read BATCH at a time and looked up together with
+ *              findElements, so that the set can overlap the cache misses
+ *              of the whole batch.  Only the words not found are copied
+ *              and added, and a copy is discarded if the same word was
+ *              added from earlier in the batch.
  */
 
 # include <stdio.h>
@@ -19,28 +25,41 @@
 # include <string.h>
 # include <stdbool.h>
 # include "set.h"
+# include "hash.h"
 
 
 /* This is sufficient for the test cases in /scratch/coen12. */
 
 # define MAX_SIZE 18000
 
+# define BATCH 1024
+
+# define POOL (BATCH * 16 + BUFSIZ)
+
 
 /*
- * Function:    strhash
+ * Function:    readWords
  *
- * Description: Return a hash value for a string S.
+ * Description: Read up to BATCH words from FP into POOL, which holds POOL
+ *		characters, and store a pointer to each in WORDS.  Reading
+ *		stops early if another word might not fit.  Return the
+ *		number of words read.
  */
 
-static unsigned strhash(char *s)
+static int readWords(FILE *fp, char *pool, char **words)
 {
-    unsigned hash = 0;
+    int n, used;
 
 
-    while (*s != '\0')
-        hash = 31 * hash + *s ++;
+    n = used = 0;
 
-    return hash;
+    while (n < BATCH && used <= POOL - BUFSIZ &&
+	    fscanf(fp, "%s", pool + used) == 1) {
+	words[n ++] = pool + used;
+	used += strlen(pool + used) + 1;
+    }
+
+    return n;
 }
 
 
@@ -53,9 +72,10 @@ static unsigned strhash(char *s)
 int main(int argc, char *argv[])
 {
     FILE *fp;
-    char buffer[BUFSIZ], **elts, *word;
+    char pool[POOL], *batch[BATCH], *copies[BATCH], *found[BATCH], **elts;
     SET *unique;
-    int i, words;
+    HASHFN hash;
+    int i, j, n, count, words;
     bool lflag = false;
 
 
@@ -79,16 +99,30 @@ int main(int argc, char *argv[])
         exit(EXIT_FAILURE);
     }
 
+    if ((hash = findHash(getenv("HASH"))) == NULL) {
+	fprintf(stderr, "%s: unknown hash %s\n", argv[0], getenv("HASH"));
+	exit(EXIT_FAILURE);
+    }
+
 
     /* Insert all words into the set. */
 
     words = 0;
-    unique = createSet(MAX_SIZE, strcmp, strhash);
+    unique = createSet(MAX_SIZE, strcmp, hash);
+
+    while ((n = readWords(fp, pool, batch)) > 0) {
+	words += n;
+	findElements(unique, (void **) batch, (void **) found, n);
+
+	for (i = j = 0; i < n; i ++)
+	    if (found[i] == NULL)
+		copies[j ++] = strdup(batch[i]);
 
-    while (fscanf(fp, "%s", buffer) == 1) {
-        words ++;
-	if (!findElement(unique, buffer))
-	    addElement(unique, strdup(buffer));
+	addElements(unique, (void **) copies, (void **) found, j);
+
+	for (i = 0; i < j; i ++)
+	    if (found[i] != copies[i])
+		free(copies[i]);
     }
 
     fclose(fp);
@@ -110,11 +144,17 @@ int main(int argc, char *argv[])
 
         /* Delete all words in the second file. */
 
-        while (fscanf(fp, "%s", buffer) == 1) {
-	    if ((word = findElement(unique, buffer)) != NULL) {
-		removeElement(unique, buffer);
-		free(word);
-	    }
+        while ((n = readWords(fp, pool, batch)) > 0) {
+	    findElements(unique, (void **) batch, (void **) found, n);
+
+	    for (i = 0; i < n; i ++)
+		if (found[i] != NULL) {
+		    count = numElements(unique);
+		    removeElement(unique, batch[i]);
+
+		    if (numElements(unique) < count)
+			free(found[i]);
+		}
 	}
 
 	fclose(fp);
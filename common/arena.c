@@ -0,0 +1,184 @@
+/*
+ * File:        arena.c
+ *
+ * Description: This file contains the definitions of an arena of strings.
+ *
+ *              Strings are allocated by bumping a pointer through large
+ *              chunks obtained from malloc, rounded up to a multiple of
+ *              ALIGN bytes.  A freed string is pushed on the free list for
+ *              its size, and the next string of the same size reuses it,
+ *              so a set that removes and adds words does not keep growing.
+ *              Strings longer than MAX_CLASS bytes are not reused.  Each
+ *              chunk begins with a pointer to the previous chunk, so
+ *              destroying the arena takes time proportional to the number
+ *              of chunks rather than the number of strings.
+ */
+
+# include <stdlib.h>
+# include <string.h>
+# include <assert.h>
+# include "arena.h"
+
+# define ALIGN	    sizeof(void *)
+# define MAX_CLASS  256
+# define CHUNK_SIZE (64 * 1024)
+
+typedef struct chunk {
+    struct chunk *prev;
+} CHUNK;
+
+struct arena {
+    CHUNK *chunks;
+    char *next;
+    char *end;
+    char *free[MAX_CLASS / ALIGN];
+};
+
+
+/*
+ * Function:    createArena
+ *
+ * Complexity:  O(1)
+ *
+ * Description: Return a pointer to a new arena with no chunks.
+ */
+
+ARENA *createArena(void)
+{
+    ARENA *ap;
+
+
+    ap = calloc(1, sizeof(ARENA));
+    assert(ap != NULL);
+    return ap;
+}
+
+
+/*
+ * Function:    destroyArena
+ *
+ * Complexity:  O(c)
+ *
+ * Description: Deallocate memory associated with the arena pointed to by
+ *		AP, including every string allocated from it.
+ */
+
+void destroyArena(ARENA *ap)
+{
+    CHUNK *cp;
+
+
+    assert(ap != NULL);
+
+    while (ap->chunks != NULL) {
+	cp = ap->chunks;
+	ap->chunks = cp->prev;
+	free(cp);
+    }
+
+    free(ap);
+}
+
+
+/*
+ * Function:    allocate
+ *
+ * Complexity:  O(1)
+ *
+ * Description: Return a block of SIZE bytes, a multiple of ALIGN, from
+ *		the arena pointed to by AP, starting a new chunk if needed.
+ *		A block too large for a chunk gets a chunk of its own, which
+ *		is placed behind the current one so that the rest of the
+ *		current one is not wasted.
+ */
+
+static char *allocate(ARENA *ap, size_t size)
+{
+    CHUNK *cp;
+    char *p;
+
+
+    if (ap->end - ap->next >= size) {
+	p = ap->next;
+	ap->next += size;
+	return p;
+    }
+
+    if (size > CHUNK_SIZE - sizeof(CHUNK)) {
+	cp = malloc(sizeof(CHUNK) + size);
+	assert(cp != NULL);
+
+	if (ap->chunks != NULL) {
+	    cp->prev = ap->chunks->prev;
+	    ap->chunks->prev = cp;
+	} else {
+	    cp->prev = NULL;
+	    ap->chunks = cp;
+	}
+
+	return (char *) (cp + 1);
+    }
+
+    cp = malloc(CHUNK_SIZE);
+    assert(cp != NULL);
+    cp->prev = ap->chunks;
+    ap->chunks = cp;
+
+    p = (char *) (cp + 1);
+    ap->next = p + size;
+    ap->end = (char *) cp + CHUNK_SIZE;
+    return p;
+}
+
+
+/*
+ * Function:    arenaDup
+ *
+ * Complexity:  O(n)
+ *
+ * Description: Return a copy of the string S allocated from the arena
+ *		pointed to by AP, as strdup does.
+ */
+
+char *arenaDup(ARENA *ap, char *s)
+{
+    size_t length, size;
+    char *p;
+
+
+    assert(ap != NULL && s != NULL);
+    length = strlen(s) + 1;
+    size = (length + ALIGN - 1) / ALIGN * ALIGN;
+
+    if (size <= MAX_CLASS && ap->free[size / ALIGN - 1] != NULL) {
+	p = ap->free[size / ALIGN - 1];
+	ap->free[size / ALIGN - 1] = *(char **) p;
+    } else
+	p = allocate(ap, size);
+
+    return memcpy(p, s, length);
+}
+
+
+/*
+ * Function:    arenaFree
+ *
+ * Complexity:  O(n)
+ *
+ * Description: Return the string S, which was allocated from the arena
+ *		pointed to by AP, so that its space can be reused.
+ */
+
+void arenaFree(ARENA *ap, char *s)
+{
+    size_t size;
+
+
+    assert(ap != NULL && s != NULL);
+    size = (strlen(s) + ALIGN) / ALIGN * ALIGN;
+
+    if (size <= MAX_CLASS) {
+	*(char **) s = ap->free[size / ALIGN - 1];
+	ap->free[size / ALIGN - 1] = s;
+    }
+}
@@ -0,0 +1,24 @@
+/*
+ * File:        arena.h
+ *
+ * Description: This file contains the public function and type
+ *              declarations for an arena of strings.  A set that owns
+ *              copies of its strings allocates them from an arena instead
+ *              of calling strdup and free for each one, and releases them
+ *              all at once by destroying the arena.
+ */
+
+# ifndef ARENA_H
+# define ARENA_H
+
+typedef struct arena ARENA;
+
+ARENA *createArena(void);
+
+void destroyArena(ARENA *ap);
+
+char *arenaDup(ARENA *ap, char *s);
+
+void arenaFree(ARENA *ap, char *s);
+
+# endif /* ARENA_H */
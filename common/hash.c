@@ -0,0 +1,314 @@
+/*
+ * File:        hash.c
+ *
+ * Description: This file contains the definitions of a family of hash
+ *              functions for strings, which can be selected by name.
+ *
+ *              The functions other than strhash are keyed by a seed.
+ *              The seed is zero unless seedHash is called, except that
+ *              asking findHash for siphash first seeds it from the system
+ *              random number source, since a fixed key would defeat the
+ *              purpose of using it.
+ */
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <stdbool.h>
+# include <stdint.h>
+# include <time.h>
+# include <unistd.h>
+# include "hash.h"
+
+# define P0 0xa0761d6478bd642full	/* odd constants used by wyhash */
+# define P1 0xe7037ed1a0b428dbull
+# define P2 0x8ebc6af09c88c6e3ull
+
+static uint64_t key[2];
+static bool seeded = false;
+
+static struct {
+    char *name;
+    HASHFN hash;
+} hashes[] = {
+    { "strhash", strhash },
+    { "fnvhash", fnvhash },
+    { "widehash", widehash },
+    { "siphash", siphash },
+};
+
+
+/*
+ * Function:    strhash
+ *
+ * Description: Return a hash value for a string S.
+ */
+
+unsigned strhash(char *s)
+{
+    unsigned hash = 0;
+
+
+    while (*s != '\0')
+        hash = 31 * hash + *s ++;
+
+    return hash;
+}
+
+
+/*
+ * Function:    fnvhash
+ *
+ * Description: Return the 32-bit FNV-1a hash value for a string S.
+ */
+
+unsigned fnvhash(char *s)
+{
+    unsigned hash = 2166136261u ^ (unsigned) key[0];
+
+
+    while (*s != '\0') {
+	hash ^= (unsigned char) *s ++;
+	hash *= 16777619;
+    }
+
+    return hash;
+}
+
+
+/*
+ * Function:    read8
+ *
+ * Description: Return the eight bytes starting at P as a little-endian
+ *		integer.  Using memcpy lets the compiler use a single
+ *		unaligned load.
+ */
+
+static uint64_t read8(const unsigned char *p)
+{
+    uint64_t x;
+
+
+    memcpy(&x, p, 8);
+# if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    x = __builtin_bswap64(x);
+# endif
+    return x;
+}
+
+
+/*
+ * Function:    read4
+ *
+ * Description: Return the four bytes starting at P as a little-endian
+ *		integer.
+ */
+
+static uint64_t read4(const unsigned char *p)
+{
+    uint32_t x;
+
+
+    memcpy(&x, p, 4);
+# if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    x = __builtin_bswap32(x);
+# endif
+    return x;
+}
+
+
+/*
+ * Function:    mum
+ *
+ * Description: Return the exclusive-or of the high and low halves of the
+ *		128-bit product of A and B, which is the mixing step used
+ *		by wyhash.
+ */
+
+static uint64_t mum(uint64_t a, uint64_t b)
+{
+# ifdef __SIZEOF_INT128__
+    unsigned __int128 r = (unsigned __int128) a * b;
+
+
+    return (uint64_t) (r >> 64) ^ (uint64_t) r;
+# else
+    uint64_t ha, hb, la, lb, hi, lo, rh, rm0, rm1, rl, t;
+
+
+    ha = a >> 32, hb = b >> 32, la = (uint32_t) a, lb = (uint32_t) b;
+    rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    t = rl + (rm0 << 32);
+    lo = t + (rm1 << 32);
+    hi = rh + (rm0 >> 32) + (rm1 >> 32) + (t < rl) + (lo < t);
+    return hi ^ lo;
+# endif
+}
+
+
+/*
+ * Function:    widehash
+ *
+ * Description: Return a hash value for a string S, mixing in sixteen bytes
+ *		with each 64-bit multiply as wyhash does.  Finding the
+ *		length first costs one pass with the library's vectorized
+ *		strlen.  A string of up to sixteen bytes is then read with
+ *		at most four overlapping loads and no loop at all, and the
+ *		last sixteen bytes of a longer one are likewise read with
+ *		two loads that may overlap the ones before them.
+ */
+
+unsigned widehash(char *s)
+{
+    const unsigned char *p = (const unsigned char *) s;
+    uint64_t a, b, seed;
+    size_t i, n;
+
+
+    n = strlen(s);
+    seed = key[0] ^ mum(key[0] ^ P0, P1);
+
+    if (n <= 16) {
+	if (n >= 4) {
+	    i = n >> 3 << 2;
+	    a = read4(p) << 32 | read4(p + i);
+	    b = read4(p + n - 4) << 32 | read4(p + n - 4 - i);
+
+	} else if (n > 0) {
+	    a = (uint64_t) p[0] << 16 | (uint64_t) p[n >> 1] << 8 | p[n - 1];
+	    b = 0;
+
+	} else
+	    a = b = 0;
+
+    } else {
+	for (i = n; i > 16; i -= 16, p += 16)
+	    seed = mum(read8(p) ^ P1, read8(p + 8) ^ seed);
+
+	a = read8(p + i - 16);
+	b = read8(p + i - 8);
+    }
+
+    a = mum(a ^ P1, b ^ seed);
+    a = mum(a ^ P0 ^ n, P1);
+    return (unsigned) (a ^ a >> 32);
+}
+
+
+/*
+ * Function:    sipround
+ *
+ * Description: Perform one SipRound on the state V.
+ */
+
+# define ROTL(x, b) (((x) << (b)) | ((x) >> (64 - (b))))
+
+static void sipround(uint64_t v[4])
+{
+    v[0] += v[1], v[1] = ROTL(v[1], 13), v[1] ^= v[0], v[0] = ROTL(v[0], 32);
+    v[2] += v[3], v[3] = ROTL(v[3], 16), v[3] ^= v[2];
+    v[0] += v[3], v[3] = ROTL(v[3], 21), v[3] ^= v[0];
+    v[2] += v[1], v[1] = ROTL(v[1], 17), v[1] ^= v[2], v[2] = ROTL(v[2], 32);
+}
+
+
+/*
+ * Function:    siphash
+ *
+ * Description: Return a hash value for a string S using SipHash-2-4 with
+ *		the current key, folding the 64-bit result to 32 bits.
+ */
+
+unsigned siphash(char *s)
+{
+    const unsigned char *p = (const unsigned char *) s;
+    uint64_t m, v[4];
+    size_t len, n;
+
+
+    v[0] = key[0] ^ 0x736f6d6570736575ull;
+    v[1] = key[1] ^ 0x646f72616e646f6dull;
+    v[2] = key[0] ^ 0x6c7967656e657261ull;
+    v[3] = key[1] ^ 0x7465646279746573ull;
+
+    for (n = len = strlen(s); n >= 8; n -= 8, p += 8) {
+	m = read8(p);
+	v[3] ^= m;
+	sipround(v);
+	sipround(v);
+	v[0] ^= m;
+    }
+
+    for (m = (uint64_t) len << 56; n > 0; n --)
+	m |= (uint64_t) p[n - 1] << 8 * (n - 1);
+
+    v[3] ^= m;
+    sipround(v);
+    sipround(v);
+    v[0] ^= m;
+
+    v[2] ^= 0xff;
+    sipround(v);
+    sipround(v);
+    sipround(v);
+    sipround(v);
+
+    m = v[0] ^ v[1] ^ v[2] ^ v[3];
+    return (unsigned) (m ^ m >> 32);
+}
+
+
+/*
+ * Function:    seedHash
+ *
+ * Description: Set the key used by the keyed hash functions to one derived
+ *		from SEED.  Calling this with the same seed gives the same
+ *		hash values in every run.
+ */
+
+void seedHash(unsigned long long seed)
+{
+    key[0] = seed;
+    key[1] = mum(seed ^ P0, P2);
+    seeded = true;
+}
+
+
+/*
+ * Function:    findHash
+ *
+ * Description: Return the hash function called NAME, or NULL if there is no
+ *		such function.  A null NAME gives strhash, which is what
+ *		the labs have always used.
+ */
+
+HASHFN findHash(char *name)
+{
+    unsigned long long seed;
+    FILE *fp;
+    int i;
+
+
+    if (name == NULL)
+	return strhash;
+
+    for (i = 0; i < sizeof(hashes) / sizeof(hashes[0]); i ++)
+	if (strcmp(name, hashes[i].name) == 0) {
+	    if (hashes[i].hash == siphash && !seeded) {
+		seed = time(NULL) ^ (unsigned long long) getpid() << 32;
+
+		if ((fp = fopen("/dev/urandom", "r")) != NULL) {
+		    if (fread(&seed, sizeof(seed), 1, fp) != 1)
+			seed ^= (uintptr_t) &seed;
+
+		    fclose(fp);
+		}
+
+		seedHash(seed);
+	    }
+
+	    return hashes[i].hash;
+	}
+
+    return NULL;
+}
@@ -0,0 +1,37 @@
+/*
+ * File:        hash.h
+ *
+ * Description: This file contains the public function and type
+ *              declarations for a family of hash functions for strings.
+ *              Every lab that hashes strings links with hash.o instead of
+ *              keeping its own copy of strhash.
+ *
+ *              strhash is the classic hash = 31 * hash + c.  fnvhash is
+ *              32-bit FNV-1a, which still works a byte at a time but mixes
+ *              every byte into all of the bits.  widehash consumes sixteen
+ *              bytes per multiply in the style of wyhash.  siphash is
+ *              SipHash-2-4 and is meant for input chosen by an adversary,
+ *              since its output cannot be predicted without the key.
+ *
+ *              The drivers choose a function by passing the value of the
+ *              HASH environment variable to findHash.
+ */
+
+# ifndef HASH_H
+# define HASH_H
+
+typedef unsigned (*HASHFN)(char *s);
+
+unsigned strhash(char *s);
+
+unsigned fnvhash(char *s);
+
+unsigned widehash(char *s);
+
+unsigned siphash(char *s);
+
+void seedHash(unsigned long long seed);
+
+HASHFN findHash(char *name);
+
+# endif /* HASH_H */
@@ -0,0 +1,160 @@
+/*
+ * File:        hashbench.c
+ *
+ * Description: This file contains the main function for measuring the
+ *              speed of the hash functions in hash.c.
+ *
+ *              The program takes a single file as a command line argument
+ *              and reads all of its words into one contiguous buffer, so
+ *              that the measurement is not dominated by cache misses on
+ *              scattered strings.  Each hash function
+ *              is then run over every word several times, and the number of
+ *              bytes hashed per cycle and cycles per word are printed.
+ *              Where the cycle counter is not available, nanoseconds are
+ *              used instead.
+ *
+ *              The quality of each function is measured by the probes
+ *              program of each lab, which runs the parity workload on that
+ *              lab's set and prints the resulting distribution of probe or
+ *              chain lengths.  The function is selected by name with the
+ *              HASH environment variable, as in every other driver, e.g.,
+ *              "HASH=fnvhash ../Lab\ 6/probes file".
+ */
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <time.h>
+# include <assert.h>
+# include "hash.h"
+
+# if defined(__x86_64__) || defined(__i386__)
+# include <x86intrin.h>
+# define UNIT "cycle"
+# define now() __rdtsc()
+# else
+# define UNIT "ns"
+# define now() nanoseconds()
+# define NANOSECONDS
+# endif
+
+# define ROUNDS 10
+
+static char *names[] = { "strhash", "fnvhash", "widehash", "siphash" };
+
+
+# ifdef NANOSECONDS
+/*
+ * Function:    nanoseconds
+ *
+ * Description: Return the current value of a monotonic clock in
+ *		nanoseconds.
+ */
+
+static unsigned long long nanoseconds(void)
+{
+    struct timespec ts;
+
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+# endif
+
+
+/*
+ * Function:    main
+ *
+ * Description: Driver function for the benchmark.
+ */
+
+int main(int argc, char *argv[])
+{
+    FILE *fp;
+    char buffer[BUFSIZ], **words, *text;
+    unsigned long long start, ticks, bytes, size, used;
+    unsigned sum;
+    HASHFN hash;
+    int i, j, n, length, round;
+
+
+    /* Check usage and open the file. */
+
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s file\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    if ((fp = fopen(argv[1], "r")) == NULL) {
+        fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[1]);
+        exit(EXIT_FAILURE);
+    }
+
+
+    /* Read all of the words into memory.  Each word is followed by at
+       least one space or newline in the file, or by its end, so the text
+       needs no more than the size of the file plus one. */
+
+    fseek(fp, 0, SEEK_END);
+    size = ftell(fp) + 1;
+    rewind(fp);
+
+    text = malloc(size);
+    assert(text != NULL);
+
+    n = 0;
+    length = 1024;
+    bytes = used = 0;
+    words = malloc(sizeof(char *) * length);
+    assert(words != NULL);
+
+    while (fscanf(fp, "%s", buffer) == 1) {
+	if (n == length) {
+	    length *= 2;
+	    words = realloc(words, sizeof(char *) * length);
+	    assert(words != NULL);
+	}
+
+	words[n ++] = strcpy(text + used, buffer);
+	bytes += strlen(buffer);
+	used += strlen(buffer) + 1;
+    }
+
+    fclose(fp);
+
+    if (n == 0) {
+	fprintf(stderr, "%s: no words in %s\n", argv[0], argv[1]);
+	exit(EXIT_FAILURE);
+    }
+
+
+    /* Time each function, keeping a sum so the calls are not removed. */
+
+    sum = 0;
+    seedHash(1);
+    printf("%d words, %llu bytes\n\n", n, bytes);
+    printf("hash       bytes/%-6s %s/word\n", UNIT, UNIT);
+
+    for (i = 0; i < sizeof(names) / sizeof(names[0]); i ++) {
+	hash = findHash(names[i]);
+
+	for (j = 0; j < n; j ++)
+	    sum += (*hash)(words[j]);
+
+	start = now();
+
+	for (round = 0; round < ROUNDS; round ++)
+	    for (j = 0; j < n; j ++)
+		sum += (*hash)(words[j]);
+
+	ticks = now() - start;
+	printf("%-10s %10.3f %12.2f\n", names[i],
+	    (double) bytes * ROUNDS / ticks, (double) ticks / ROUNDS / n);
+    }
+
+    printf("\nchecksum %08x\n", sum);
+
+    free(words);
+    free(text);
+    exit(EXIT_SUCCESS);
+}